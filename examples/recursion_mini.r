@@ -0,0 +1,30 @@
+# Deep self-recursion micro benchmark. Compare against a run with
+#   PIR_PASS_BLACKLIST=TailCallElimination
+# to see the effect of turning tail calls into loops, the non-tail case
+# exercises direct native self-calls.
+
+sumTo <- function(n, acc) {
+    if (n == 0)
+        acc
+    else
+        sumTo(n - 1, acc + n)
+}
+
+fib <- function(n) {
+    if (n < 2)
+        n
+    else
+        fib(n - 1) + fib(n - 2)
+}
+
+run <- function() {
+    for (i in 1:200)
+        sumTo(2000, 0)
+    fib(22)
+}
+
+# Warmup, such that both functions are optimized
+for (i in 1:5)
+    run()
+
+print(system.time(for (i in 1:10) run()))
@@ -0,0 +1,95 @@
+# Runs one benchmark kernel and records the time of every iteration, together
+# with the PIR compilations and deopts which happened during it.
+#
+# Usage: harness.r <kernel> <iterations> <results dir> [<baseline>]
+#
+# The kernel defines execute() which runs one iteration and
+# verifyResult(result). Per-iteration timings are written to
+# <results dir>/<kernel>.csv and a summary line is appended to
+# <results dir>/summary.csv. If a baseline summary is given, the steady state
+# is compared against the one recorded there.
+
+args <- commandArgs(trailingOnly = TRUE)
+if (length(args) < 3)
+    stop("usage: harness.r <kernel> <iterations> <results dir> [<baseline>]")
+kernel <- args[[1]]
+iterations <- as.integer(args[[2]])
+resultsDir <- args[[3]]
+baseline <- if (length(args) > 3) args[[4]] else ""
+if (baseline != "" && !file.exists(baseline))
+    stop("could not find the baseline ", baseline)
+
+# Steady state iterations are within this factor of the median of the
+# iterations which follow the last compilation or deopt
+steadyTolerance <- 1.1
+# Changes of the steady state against the baseline below this factor are
+# considered noise
+baselineTolerance <- 1.05
+
+name <- sub("\\.[rR]$", "", basename(kernel))
+source(kernel)
+
+time <- numeric(iterations)
+compiles <- integer(iterations)
+deopts <- integer(iterations)
+for (i in 1:iterations) {
+    c0 <- rir.compileCount()
+    d0 <- rir.deoptCount()
+    t0 <- Sys.time()
+    result <- execute()
+    time[[i]] <- as.numeric(difftime(Sys.time(), t0, units = "secs")) * 1000
+    compiles[[i]] <- rir.compileCount() - c0
+    deopts[[i]] <- rir.deoptCount() - d0
+    if (!verifyResult(result))
+        stop(name, ": wrong result in iteration ", i)
+}
+
+# Iterations are in the compile or deopt phase if the JIT was busy during
+# them, in the warmup phase until they settle to the steady state after the
+# last of those.
+phase <- ifelse(compiles > 0, "compile",
+                ifelse(deopts > 0, "deopt", "warmup"))
+events <- which(compiles > 0 | deopts > 0)
+steadyStart <- if (length(events) == 0) 1 else max(events) + 1
+steady <- NA
+if (steadyStart <= iterations) {
+    settled <- median(time[steadyStart:iterations])
+    while (time[[steadyStart]] > steadyTolerance * settled)
+        steadyStart <- steadyStart + 1
+    phase[steadyStart:iterations] <- "steady"
+    steady <- median(time[steadyStart:iterations])
+}
+
+write.csv(data.frame(iteration = 1:iterations, time = time,
+                     compiles = compiles, deopts = deopts, phase = phase),
+          file.path(resultsDir, paste0(name, ".csv")), row.names = FALSE)
+
+summary <- data.frame(benchmark = name, iterations = iterations,
+                      first = time[[1]], steady = steady,
+                      warmup = if (is.na(steady)) iterations
+                               else steadyStart - 1,
+                      compiles = sum(compiles), deopts = sum(deopts))
+summaryFile <- file.path(resultsDir, "summary.csv")
+write.table(summary, summaryFile, sep = ",", row.names = FALSE,
+            col.names = !file.exists(summaryFile),
+            append = file.exists(summaryFile))
+
+fmt <- function(ms) if (is.na(ms)) "-" else sprintf("%.2fms", ms)
+cat(sprintf("%-12s first %10s  steady %10s  warmup %4d  compiles %3d  ",
+            name, fmt(summary$first), fmt(steady), summary$warmup,
+            summary$compiles),
+    sprintf("deopts %3d", summary$deopts), sep = "")
+
+if (baseline != "") {
+    base <- read.csv(baseline)
+    base <- base[base$benchmark == name, ]
+    if (nrow(base) == 1 && !is.na(base$steady) && !is.na(steady)) {
+        ratio <- steady / base$steady
+        verdict <- if (ratio > baselineTolerance) "slower"
+                   else if (ratio < 1 / baselineTolerance) "faster"
+                   else "same"
+        cat(sprintf("  baseline %10s  %.2fx %s", fmt(base$steady), ratio,
+                    verdict))
+    }
+}
+cat("\n")
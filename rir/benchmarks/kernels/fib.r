@@ -0,0 +1,7 @@
+# Naive recursive fibonacci numbers. Exercises closure calls.
+
+fib <- function(n) if (n < 2L) n else fib(n - 1L) + fib(n - 2L)
+
+execute <- function() fib(20L)
+
+verifyResult <- function(result) result == 6765L
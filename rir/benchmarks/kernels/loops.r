@@ -0,0 +1,12 @@
+# Nested counting loops. Exercises scalar arithmetic which should stay
+# unboxed.
+
+execute <- function() {
+    s <- 0L
+    for (i in 1:300)
+        for (j in 1:300)
+            s <- s + (i * j) %% 7L
+    s
+}
+
+verifyResult <- function(result) result == 232974L
@@ -0,0 +1,58 @@
+# The Mandelbrot set, from the are-we-fast-yet suite. Exercises floating point
+# arithmetic in nested while loops.
+
+execute <- function() {
+    size <- 100
+    sum <- 0
+    byteAcc <- 0
+    bitNum <- 0
+
+    y <- 0
+    while (y < size) {
+        ci <- (2.0 * y / size) - 1.0
+        x <- 0
+
+        while (x < size) {
+            zrzr <- 0.0
+            zi <- 0.0
+            zizi <- 0.0
+            cr <- (2.0 * x / size) - 1.5
+
+            z <- 0
+            notDone <- TRUE
+            escape <- 0
+            while (notDone && (z < 50)) {
+                zr <- zrzr - zizi + cr
+                zi <- 2.0 * zr * zi + ci
+
+                zrzr <- zr * zr
+                zizi <- zi * zi
+
+                if ((zrzr + zizi) > 4.0) {
+                    notDone <- FALSE
+                    escape <- 1
+                }
+                z <- z + 1
+            }
+
+            byteAcc <- bitwShiftL(byteAcc, 1) + escape
+            bitNum <- bitNum + 1
+
+            if (bitNum == 8) {
+                sum <- bitwXor(sum, byteAcc)
+                byteAcc <- 0
+                bitNum <- 0
+            } else if (x == (size - 1)) {
+                byteAcc <- bitwShiftL(byteAcc, 8 - bitNum)
+                sum <- bitwXor(sum, byteAcc)
+                byteAcc <- 0
+                bitNum <- 0
+            }
+            x <- x + 1
+        }
+        y <- y + 1
+    }
+    sum
+}
+
+verifyResult <- function(result) result == 239
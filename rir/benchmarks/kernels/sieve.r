@@ -0,0 +1,20 @@
+# The sieve of Eratosthenes. Exercises integer loops and vector updates.
+
+execute <- function() {
+    n <- 5000L
+    flags <- rep(TRUE, n)
+    count <- 0L
+    for (i in 2:n) {
+        if (flags[[i]]) {
+            count <- count + 1L
+            j <- i * i
+            while (j <= n) {
+                flags[[j]] <- FALSE
+                j <- j + i
+            }
+        }
+    }
+    count
+}
+
+verifyResult <- function(result) result == 669L
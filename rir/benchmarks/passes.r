@@ -0,0 +1,52 @@
+# Times the PIR passes on a corpus of closures with type feedback.
+#
+# Usage: passes.r <kernels dir> <corpus dir> <results dir>
+#
+# The corpus consists of files written by rir.serialize, each containing a
+# list of closures. Kernels which have no file in the corpus yet are run a
+# few times and their closures are added to it. The per-pass results are
+# written to <results dir>/passes.csv.
+
+args <- commandArgs(trailingOnly = TRUE)
+if (length(args) < 3)
+    stop("usage: passes.r <kernels dir> <corpus dir> <results dir>")
+kernelsDir <- args[[1]]
+corpusDir <- args[[2]]
+resultsDir <- args[[3]]
+
+# Runs of a kernel before its closures are saved, enough to get feedback
+# but not to optimize them
+warmupRuns <- 2
+
+dir.create(corpusDir, showWarnings = FALSE, recursive = TRUE)
+for (kernel in list.files(kernelsDir, pattern = "\\.[rR]$",
+                          full.names = TRUE)) {
+    saved <- file.path(corpusDir,
+                       sub("\\.[rR]$", ".rds", basename(kernel)))
+    if (file.exists(saved))
+        next
+    env <- new.env()
+    sys.source(kernel, env)
+    for (i in 1:warmupRuns)
+        env$execute()
+    closures <- Filter(function(x) is.function(x) && rir.isValidFunction(x),
+                       as.list(env))
+    rir.serialize(closures, saved)
+}
+
+corpus <- list()
+for (saved in list.files(corpusDir, pattern = "\\.rds$", full.names = TRUE))
+    corpus <- c(corpus, unname(rir.deserialize(saved)))
+
+res <- pir.benchmarkPasses(corpus)
+res <- res[order(-res$pipelineTime), ]
+write.csv(res, file.path(resultsDir, "passes.csv"), row.names = FALSE)
+
+cat(sprintf("%d closures\n", length(corpus)))
+cat(sprintf("%-28s %12s %6s %8s %12s %8s\n", "pass", "pipeline", "runs",
+            "delta", "isolated", "delta"))
+for (i in seq_len(nrow(res)))
+    cat(sprintf("%-28s %10.2fms %6d %8d %10.2fms %8d\n", res$pass[[i]],
+                res$pipelineTime[[i]], as.integer(res$pipelineRuns[[i]]),
+                as.integer(res$pipelineDelta[[i]]), res$isolatedTime[[i]],
+                as.integer(res$isolatedDelta[[i]])))
@@ -9,19 +9,25 @@
 #include "compiler/backend.h"
 #include "compiler/compiler.h"
 #include "compiler/log/debug.h"
+#include "compiler/native/builtins.h"
 #include "compiler/parameter.h"
 #include "compiler/pir/closure.h"
 #include "compiler/pir/type.h"
+#include "compiler/test/PassBenchmark.h"
 #include "compiler/test/PirCheck.h"
 #include "compiler/test/PirTests.h"
+#include "interpreter/compile_budget.h"
 #include "interpreter/interp_incl.h"
 #include "utils/measuring.h"
 
 #include <cassert>
+#include <climits>
 #include <cstdio>
 #include <list>
 #include <memory>
+#include <sstream>
 #include <string>
+#include <vector>
 
 using namespace rir;
 
@@ -34,6 +40,8 @@ static size_t oldInlinerMax = 0;
 static bool oldPreserve = false;
 static unsigned oldSerializeChaos = false;
 static size_t oldDeoptChaos = false;
+// Number of closures which were optimized by pirCompile
+static size_t pirCompilations = 0;
 
 bool parseDebugStyle(const char* str, pir::DebugStyle& s) {
 #define V(style)                                                               \
@@ -48,7 +56,7 @@ bool parseDebugStyle(const char* str, pir::DebugStyle& s) {
     }
 }
 
-REXPORT SEXP rirDisassemble(SEXP what, SEXP verbose) {
+REXPORT SEXP rirDisassemble(SEXP what, SEXP verbose, SEXP asText) {
     if (!what || TYPEOF(what) != CLOSXP)
         Rf_error("Not a rir compiled code (Not CLOSXP)");
     DispatchTable* t = DispatchTable::check(BODY(what));
@@ -56,15 +64,30 @@ REXPORT SEXP rirDisassemble(SEXP what, SEXP verbose) {
     if (!t)
         Rf_error("Not a rir compiled code (CLOSXP but not DispatchTable)");
 
-    std::cout << "== closure " << what << " (dispatch table " << t << ", env "
-              << CLOENV(what) << ") ==\n";
+    bool text = Rf_asLogical(asText) == TRUE;
+    std::stringstream lines;
+    std::ostream& out = text ? lines : std::cout;
+    out << "== closure " << what << " (dispatch table " << t << ", env "
+        << CLOENV(what) << ") ==\n";
     for (size_t entry = 0; entry < t->size(); ++entry) {
         Function* f = t->get(entry);
-        std::cout << "= version " << entry << " (" << f << ") =\n";
-        f->disassemble(std::cout);
+        out << "= version " << entry << " (" << f << ") =\n";
+        f->disassemble(out);
     }
 
-    return R_NilValue;
+    if (!text)
+        return R_NilValue;
+
+    // One element per line, e.g. for the tests to grep
+    std::vector<std::string> res;
+    std::string line;
+    while (std::getline(lines, line))
+        res.push_back(line);
+    SEXP v = PROTECT(Rf_allocVector(STRSXP, res.size()));
+    for (size_t i = 0; i < res.size(); ++i)
+        SET_STRING_ELT(v, i, Rf_mkChar(res[i].c_str()));
+    UNPROTECT(1);
+    return v;
 }
 
 REXPORT SEXP rirCompile(SEXP what, SEXP env) {
@@ -311,6 +334,7 @@ SEXP pirCompile(SEXP what, const Context& assumptions, const std::string& name,
         if (dryRun)
             return;
 
+        pirCompilations++;
         rir::Function* done = nullptr;
         {
             // Single Backend instance, gets destroyed at the end of this block
@@ -459,6 +483,21 @@ REXPORT SEXP pirCheck(SEXP f, SEXP checksSxp, SEXP env) {
     return res ? R_TrueValue : R_FalseValue;
 }
 
+REXPORT SEXP pirBenchmarkPasses(SEXP closures, SEXP env) {
+    if (TYPEOF(closures) != VECSXP)
+        Rf_error("pirBenchmarkPasses: expects a list of closures");
+    PassBenchmark benchmark;
+    for (R_xlen_t i = 0; i < XLENGTH(closures); ++i) {
+        SEXP f = VECTOR_ELT(closures, i);
+        if (TYPEOF(f) != CLOSXP)
+            continue;
+        if (!isValidClosureSEXP(f))
+            rirCompile(f, env);
+        benchmark.run(f);
+    }
+    return benchmark.toList();
+}
+
 SEXP rirOptDefaultOpts(SEXP closure, const Context& assumptions, SEXP name) {
     std::string n = "";
     if (TYPEOF(name) == SYMSXP)
@@ -515,6 +554,56 @@ REXPORT SEXP rirDeserialize(SEXP fileSexp) {
     return res;
 }
 
+REXPORT SEXP rirPoolStats() {
+    auto stats = Pool::stats();
+    SEXP res = PROTECT(Rf_allocVector(INTSXP, 4));
+    SEXP names = PROTECT(Rf_allocVector(STRSXP, 4));
+    size_t values[] = {stats.size, stats.free, stats.interned, stats.owned};
+    const char* labels[] = {"size", "free", "interned", "owned"};
+    for (int i = 0; i < 4; ++i) {
+        INTEGER(res)[i] = values[i];
+        SET_STRING_ELT(names, i, Rf_mkChar(labels[i]));
+    }
+    Rf_setAttrib(res, R_NamesSymbol, names);
+    UNPROTECT(2);
+    return res;
+}
+
+REXPORT SEXP rirDeoptCount() {
+    return Rf_ScalarReal(pir::NativeBuiltins::deopts);
+}
+
+REXPORT SEXP rirCompileCount() { return Rf_ScalarReal(pirCompilations); }
+
+REXPORT SEXP pirNativeModuleCount() {
+    return Rf_ScalarReal(pir::PirJitLLVM::liveModules());
+}
+
+REXPORT SEXP rirCompileBudgetStats() {
+    auto stats = CompileBudget::stats();
+    SEXP res = PROTECT(Rf_allocVector(INTSXP, 4));
+    SEXP names = PROTECT(Rf_allocVector(STRSXP, 4));
+    size_t values[] = {stats.admitted, stats.deferred, stats.dropped,
+                       stats.pending};
+    const char* labels[] = {"admitted", "deferred", "dropped", "pending"};
+    for (int i = 0; i < 4; ++i) {
+        INTEGER(res)[i] = values[i];
+        SET_STRING_ELT(names, i, Rf_mkChar(labels[i]));
+    }
+    Rf_setAttrib(res, R_NamesSymbol, names);
+    UNPROTECT(2);
+    return res;
+}
+
+REXPORT SEXP rirSetCompileBudget(SEXP ticks) {
+    auto budget = Rf_asReal(ticks);
+    if (ISNAN(budget) || budget < 0 || budget > UINT_MAX)
+        Rf_error("rirSetCompileBudget expects a number of ticks");
+    auto old = pir::Parameter::PIR_COMPILE_BUDGET;
+    pir::Parameter::PIR_COMPILE_BUDGET = budget;
+    return Rf_ScalarReal(old);
+}
+
 REXPORT SEXP rirEnableLoopPeeling() {
     Compiler::loopPeelingEnabled = true;
     return R_NilValue;
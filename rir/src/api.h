@@ -17,6 +17,7 @@ REXPORT SEXP pirCompileWrapper(SEXP closure, SEXP name, SEXP debugFlags,
 REXPORT SEXP rirCompile(SEXP what, SEXP env);
 REXPORT SEXP pirTests();
 REXPORT SEXP pirCheck(SEXP f, SEXP check, SEXP env);
+REXPORT SEXP pirBenchmarkPasses(SEXP closures, SEXP env);
 REXPORT SEXP pirSetDebugFlags(SEXP debugFlags);
 SEXP pirCompile(SEXP closure, const rir::Context& assumptions,
                 const std::string& name, const rir::pir::DebugOptions& debug);
@@ -25,6 +26,12 @@ extern SEXP rirOptDefaultOptsDryrun(SEXP closure, const rir::Context&,
                                     SEXP name);
 REXPORT SEXP rirSerialize(SEXP data, SEXP file);
 REXPORT SEXP rirDeserialize(SEXP file);
+REXPORT SEXP rirPoolStats();
+REXPORT SEXP rirDeoptCount();
+REXPORT SEXP rirCompileCount();
+REXPORT SEXP pirNativeModuleCount();
+REXPORT SEXP rirCompileBudgetStats();
+REXPORT SEXP rirSetCompileBudget(SEXP ticks);
 
 REXPORT SEXP rirSetUserContext(SEXP f, SEXP udc);
 REXPORT SEXP rirCreateSimpleIntContext();
@@ -66,6 +66,7 @@ void BC::write(CodeStream& cs) const {
 
     case Opcode::call_:
         cs.insert(immediate.callFixedArgs);
+        cs.insert(CallContextCache{0, Context()});
         break;
 
     case Opcode::named_call_:
@@ -73,6 +74,8 @@ void BC::write(CodeStream& cs) const {
         cs.insert(immediate.callFixedArgs);
         for (PoolIdx name : callExtra().callArgumentNames)
             cs.insert(name);
+        if (bc == Opcode::named_call_)
+            cs.insert(CallArgmatchCache());
         break;
 
     case Opcode::call_builtin_:
@@ -88,6 +91,7 @@ void BC::write(CodeStream& cs) const {
     case Opcode::brtrue_:
     case Opcode::beginloop_:
     case Opcode::brfalse_:
+    case Opcode::asbool_brtrue_:
         cs.patchpoint(immediate.offset);
         break;
 
@@ -159,12 +163,17 @@ void BC::deserialize(SEXP refTable, R_inpstream_t inp, Opcode* code,
             i.callFixedArgs.ast = Pool::insert(ReadItem(refTable, inp));
             InBytes(inp, &i.callFixedArgs.given, sizeof(Context));
             Opcode* c = code + 1 + sizeof(CallFixedArgs);
+            if (*code == Opcode::call_)
+                memset(c, 0, sizeof(CallContextCache));
             // Read implicit promise argument offsets
             // Read named arguments
             if (*code == Opcode::named_call_ || *code == Opcode::call_dots_) {
                 PoolIdx* names = (PoolIdx*)c;
                 for (size_t j = 0; j < i.callFixedArgs.nargs; j++)
                     names[j] = Pool::insert(ReadItem(refTable, inp));
+                if (*code == Opcode::named_call_)
+                    memset(names + i.callFixedArgs.nargs, 0,
+                           sizeof(CallArgmatchCache));
             }
             break;
         }
@@ -183,6 +192,7 @@ void BC::deserialize(SEXP refTable, R_inpstream_t inp, Opcode* code,
         case Opcode::brtrue_:
         case Opcode::beginloop_:
         case Opcode::brfalse_:
+        case Opcode::asbool_brtrue_:
         case Opcode::popn_:
         case Opcode::pick_:
         case Opcode::pull_:
@@ -274,6 +284,7 @@ void BC::serialize(SEXP refTable, R_outpstream_t out, const Opcode* code,
         case Opcode::brtrue_:
         case Opcode::beginloop_:
         case Opcode::brfalse_:
+        case Opcode::asbool_brtrue_:
         case Opcode::popn_:
         case Opcode::pick_:
         case Opcode::pull_:
@@ -437,7 +448,8 @@ void BC::print(std::ostream& out) const {
             out << "F";
             break;
         case ObservedTest::Both:
-            out << "?";
+            out << "? " << immediate.testFeedback.trueCount << ":"
+                << immediate.testFeedback.falseCount;
             break;
         }
         out << " ]";
@@ -462,6 +474,7 @@ void BC::print(std::ostream& out) const {
     case Opcode::beginloop_:
     case Opcode::brtrue_:
     case Opcode::brfalse_:
+    case Opcode::asbool_brtrue_:
     case Opcode::br_:
         out << immediate.offset;
         break;
@@ -89,6 +89,22 @@ class BC {
         Immediate ast;
         Context given;
     };
+    // Trailing immediates of call_: the context inferred for the last call
+    // through this site, keyed by a fingerprint of the callee signature and
+    // the kind of every argument. Patched in place by the interpreter, a zero
+    // fingerprint never matches.
+    struct CallContextCache {
+        uint64_t fingerprint;
+        Context inferred;
+    };
+    // Trailing immediates of named_call_, after the names: the formal each
+    // supplied argument was matched to, for the last callee formals seen at
+    // this site. The formals are only compared, never dereferenced.
+    struct CallArgmatchCache {
+        uintptr_t formals;
+        uint8_t nformals;
+        uint8_t position[7];
+    };
     struct CallBuiltinFixedArgs {
         NumArgs nargs;
         Immediate ast;
@@ -260,7 +276,7 @@ class BC {
 
     bool isCondJmp() const {
         return bc == Opcode::brtrue_ || bc == Opcode::brfalse_ ||
-               bc == Opcode::beginloop_;
+               bc == Opcode::asbool_brtrue_ || bc == Opcode::beginloop_;
     }
 
     bool isUncondJmp() const { return bc == Opcode::br_; }
@@ -275,17 +291,14 @@ class BC {
     inline static unsigned size(rir::Opcode* pc) {
         auto bc = *pc;
         switch (bc) {
-        // First handle the varlength BCs. In all three cases the number of
-        // call arguments is the 2nd immediate argument and the
-        // instructions have 4 fixed length immediates. After that there are
-        // narg varlen immediates for the first two and 2*narg varlen
-        // immediates in the last case.
+        // First handle the varlength BCs. In both cases the number of
+        // call arguments is the 1st immediate argument and there are narg
+        // varlen immediates besides the fixed length ones.
         case Opcode::call_dots_:
         case Opcode::named_call_: {
-            pc++;
             Immediate nargs;
-            memcpy(&nargs, pc, sizeof(Immediate));
-            return 1 + (4 + nargs) * sizeof(Immediate);
+            memcpy(&nargs, pc + 1, sizeof(Immediate));
+            return fixedSize(bc) + nargs * sizeof(Immediate);
         }
         default: {
         }
@@ -572,6 +585,7 @@ class BC {
         case Opcode::br_:
         case Opcode::brtrue_:
         case Opcode::brfalse_:
+        case Opcode::asbool_brtrue_:
             memcpy(&immediate.offset, pc, sizeof(immediate.offset));
             break;
         case Opcode::beginloop_:
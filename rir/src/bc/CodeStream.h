@@ -15,12 +15,16 @@ namespace rir {
 class CodeStream {
 
     friend class Compiler;
+    friend class Peephole;
 
     std::vector<char>* code;
-    std::vector<Code*> promises;
+    // Compiled promises, or the AST of promises compiled on first use
+    std::vector<SEXP> promises;
 
     typedef unsigned PcOffset;
     PcOffset pos = 0;
+    // Start of the last instruction written, used to fuse superinstructions
+    PcOffset lastOp = (PcOffset)-1;
     unsigned size = 1024;
     unsigned nops = 0;
 
@@ -53,7 +57,14 @@ class CodeStream {
     size_t addPromise(Code* code) {
         preserve(code->container());
         auto s = promises.size();
-        promises.push_back(code);
+        promises.push_back(code->container());
+        return s;
+    }
+
+    size_t addLazyPromise(SEXP ast) {
+        assert(!Code::check(ast));
+        auto s = promises.size();
+        promises.push_back(ast);
         return s;
     }
 
@@ -83,10 +94,36 @@ class CodeStream {
     CodeStream& operator<<(const BC& b) {
         if (b.bc == Opcode::nop_)
             nops++;
+        if (fuse(b))
+            return *this;
+        lastOp = pos;
         b.write(*this);
         return *this;
     }
 
+    // Merges b into the previous instruction if there is a superinstruction
+    // for the pair. Nothing must be able to observe the pc in between, ie.
+    // there can be no label or source at the current position.
+    //
+    // asbool_ brtrue_ is the only pair fused so far. The other frequent ones
+    // cannot simply be merged: ldvar_ record_type_ and anything ending in
+    // record_test_ are found by the pc of the record instruction (force
+    // behavior, deopt feedback, rir2pir origins), and push_ visible_ is what
+    // the Peephole matches to drop or fold constants.
+    bool fuse(const BC& b) {
+        if (lastOp == (PcOffset)-1 || labels.count(pos) || sources.count(pos))
+            return false;
+        auto prev = reinterpret_cast<Opcode*>(&(*code)[lastOp]);
+        if (lastOp + BC::fixedSize(*prev) != pos)
+            return false;
+        if (*prev == Opcode::asbool_ && b.bc == Opcode::brtrue_) {
+            *prev = Opcode::asbool_brtrue_;
+            patchpoint(b.immediate.offset);
+            return true;
+        }
+        return false;
+    }
+
     CodeStream& operator<<(BC::Label label) {
 
         // get rid of unnecessary jumps
@@ -149,8 +186,8 @@ class CodeStream {
                                labels, localsCnt, nops, bindingsCnt);
         assert(res->extraPoolSize == 0 &&
                "promise indices and src pool idx need to be aligned");
-        for (auto c : promises)
-            res->addExtraPoolEntry(c->container());
+        for (auto p : promises)
+            res->addExtraPoolEntry(p);
 
         labels.clear();
         patchpoints.clear();
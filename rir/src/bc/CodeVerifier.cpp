@@ -104,6 +104,7 @@ static Sources hasSources(Opcode bc) {
 
     case Opcode::aslogical_:
     case Opcode::asbool_:
+    case Opcode::asbool_brtrue_:
     case Opcode::missing_:
         return Sources::May;
 
@@ -170,8 +171,9 @@ void CodeVerifier::verifyFunctionLayout(SEXP sexp) {
     // get the code objects
     std::vector<Code*> objs;
     objs.push_back(f->body());
+    // Lazy promises and default arguments are verified once compiled
     for (size_t i = 0; i < f->nargs(); ++i)
-        if (f->defaultArg(i))
+        if (!f->isLazyDefaultArg(i) && f->defaultArg(i))
             objs.push_back(f->defaultArg(i));
 
     if (f->size > XLENGTH(sexp))
@@ -217,7 +219,8 @@ void CodeVerifier::verifyFunctionLayout(SEXP sexp) {
             }
             }
             if (*cptr == Opcode::br_ || *cptr == Opcode::brtrue_ ||
-                *cptr == Opcode::brfalse_) {
+                *cptr == Opcode::brfalse_ ||
+                *cptr == Opcode::asbool_brtrue_) {
                 int off = *reinterpret_cast<int*>(cptr + 1);
                 if (cptr + cur.size() + off < start ||
                     cptr + cur.size() + off > end)
@@ -263,7 +266,12 @@ void CodeVerifier::verifyFunctionLayout(SEXP sexp) {
             if (*cptr == Opcode::mk_promise_ ||
                 *cptr == Opcode::mk_eager_promise_) {
                 unsigned* promidx = reinterpret_cast<Immediate*>(cptr + 1);
-                objs.push_back(c->getPromise(*promidx));
+                if (*promidx >= c->extraPoolSize)
+                    Rf_error("RIR Verifier: Promise index out of bounds");
+                if (!c->isLazyPromise(*promidx))
+                    objs.push_back(c->getPromise(*promidx));
+                else if (TYPEOF(c->getExtraPoolEntry(*promidx)) != LANGSXP)
+                    Rf_error("RIR Verifier: Lazy promise without an AST");
             }
             if (*cptr == Opcode::named_call_) {
                 uint32_t nargs = *reinterpret_cast<Immediate*>(cptr + 1);
@@ -6,6 +6,7 @@
 #include "bc/BC.h"
 #include "bc/CodeStream.h"
 #include "bc/CodeVerifier.h"
+#include "bc/Peephole.h"
 #include "interpreter/cache.h"
 #include "interpreter/interp.h"
 #include "interpreter/interp_incl.h"
@@ -183,6 +184,8 @@ class CompilerContext {
     }
 
     Code* pop() {
+        if (Compiler::peepholeEnabled)
+            Peephole::optimize(cs());
         Code* res = cs().finalize(0, code.top()->loadsSlotInCache.size());
         if (code.top()->isPromiseContext())
             pushedPromiseContexts--;
@@ -213,6 +216,7 @@ struct LoadArgsResult {
     int numArgs = 0;
 };
 
+bool compileLazily(SEXP exp);
 Code* compilePromise(CompilerContext& ctx, SEXP exp);
 Code* compilePromiseNoRir(CompilerContext& ctx, SEXP exp);
 // If we are in a void context, then compile expression will not leave a value
@@ -1056,7 +1060,8 @@ bool compileSpecialCall(CompilerContext& ctx, SEXP ast, SEXP fun, SEXP args_,
         BC::Label nextBranch = cs.mkLabel();
 
         compileExpr(ctx, args[0]);
-        cs << BC::asbool() << BC::brtrue(trueBranch);
+        // Recorded before asbool_, such that it still fuses with brtrue_
+        cs << BC::recordTest() << BC::asbool() << BC::brtrue(trueBranch);
 
         if (args.length() < 3) {
             if (!voidContext) {
@@ -1783,12 +1788,14 @@ static void compileLoadOneArg(CompilerContext& ctx, SEXP arg, ArgType arg_type,
         // already on TOS, no nead to compile the expression.
         // Wrap it in a promise without rir code.
         prom = compilePromiseNoRir(ctx, CAR(arg));
+    } else if (compileLazily(CAR(arg))) {
+        prom = nullptr;
     } else { // ArgType::PROMISE
         // Compile the expression as a promise.
         prom = compilePromise(ctx, CAR(arg));
     }
 
-    size_t idx = cs.addPromise(prom);
+    size_t idx = prom ? cs.addPromise(prom) : cs.addLazyPromise(CAR(arg));
 
     if (arg_type == ArgType::EAGER_PROMISE ||
         arg_type == ArgType::EAGER_PROMISE_FROM_TOS) {
@@ -1993,6 +2000,24 @@ void compileExpr(CompilerContext& ctx, SEXP exp, bool voidContext) {
     }
 }
 
+// Promises which do not break out of a surrounding loop do not depend on the
+// context they appear in. Those are only compiled when they are first used.
+bool compileLazily(SEXP exp) {
+    if (!Compiler::lazyPromisesEnabled || TYPEOF(exp) != LANGSXP)
+        return false;
+    std::function<bool(SEXP)> breaksLoop = [&](SEXP e) {
+        if (TYPEOF(e) != LANGSXP)
+            return false;
+        if (CAR(e) == symbol::Break || CAR(e) == symbol::Next)
+            return true;
+        for (auto a : RList(e))
+            if (breaksLoop(a))
+                return true;
+        return false;
+    };
+    return !breaksLoop(exp);
+}
+
 Code* compilePromise(CompilerContext& ctx, SEXP exp) {
     ctx.pushPromiseContext(exp);
     compileExpr(ctx, exp);
@@ -2023,6 +2048,8 @@ SEXP Compiler::finalize() {
     for (RListIter arg = RList(formals).begin(); arg != RList::end(); ++arg) {
         if (*arg == R_MissingArg) {
             function.addArgWithoutDefault();
+        } else if (compileLazily(*arg)) {
+            function.addLazyDefaultArg(*arg);
         } else {
             Code* compiled = compilePromise(ctx, *arg);
             function.addDefaultArg(compiled);
@@ -2071,4 +2098,21 @@ bool Compiler::profile =
 
 bool Compiler::loopPeelingEnabled = true;
 
+Code* Compiler::compileLazyPromise(SEXP ast, Function* owner) {
+    Preserve preserve;
+    FunctionWriter function;
+    CompilerContext ctx(function, preserve);
+    auto res = compilePromise(ctx, ast);
+    function.attach(owner);
+    return res;
+}
+
+bool Compiler::lazyPromisesEnabled =
+    !(getenv("RIR_LAZY_PROMISES") &&
+      std::string(getenv("RIR_LAZY_PROMISES")).compare("off") == 0);
+
+bool Compiler::peepholeEnabled =
+    !(getenv("RIR_PEEPHOLE") &&
+      std::string(getenv("RIR_PEEPHOLE")).compare("off") == 0);
+
 } // namespace rir
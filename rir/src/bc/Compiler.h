@@ -41,6 +41,13 @@ class Compiler {
     static bool profile;
     static bool unsoundOpts;
     static bool loopPeelingEnabled;
+    static bool peepholeEnabled;
+    static bool lazyPromisesEnabled;
+
+    // Compiles a promise or default argument which was left as an AST in the
+    // extra pool or the function. The result and the promises compiled
+    // eagerly into it belong to owner. The result is not preserved.
+    static Code* compileLazyPromise(SEXP ast, Function* owner);
 
     static SEXP compileExpression(SEXP ast) {
         Compiler c(ast);
@@ -0,0 +1,189 @@
+#include "Peephole.h"
+#include "R/r.h"
+#include "bc/CodeStream.h"
+
+#include <unordered_set>
+
+namespace rir {
+
+static bool isBranch(Opcode bc) {
+    return bc == Opcode::br_ || bc == Opcode::brtrue_ ||
+           bc == Opcode::brfalse_ || bc == Opcode::asbool_brtrue_;
+}
+
+static bool isVisibility(Opcode bc) {
+    return bc == Opcode::visible_ || bc == Opcode::invisible_;
+}
+
+Opcode* Peephole::at(unsigned pc) const {
+    return reinterpret_cast<Opcode*>(&(*cs.code)[pc]);
+}
+
+unsigned Peephole::skipNops(unsigned pc) const {
+    while (pc < cs.pos && *at(pc) == Opcode::nop_)
+        pc++;
+    return pc;
+}
+
+bool Peephole::entered(unsigned from, unsigned to) const {
+    auto t = targets.upper_bound(from);
+    return t != targets.end() && *t <= to;
+}
+
+bool Peephole::isConstantCondition(unsigned pc, bool& value) const {
+    SEXP c = BC::decodeShallow(at(pc)).immediateConst();
+    if (!IS_SIMPLE_SCALAR(c, LGLSXP) || LOGICAL(c)[0] == NA_LOGICAL)
+        return false;
+    value = LOGICAL(c)[0];
+    return true;
+}
+
+void Peephole::analyze() {
+    instrs.clear();
+    for (auto pc = skipNops(0); pc < cs.pos;
+         pc = skipNops(pc + BC::size(at(pc))))
+        instrs.push_back(pc);
+
+    std::unordered_set<BC::Label> used;
+    for (auto& p : cs.patchpoints)
+        used.insert(p.second);
+    targets.clear();
+    labelPos.clear();
+    for (auto& l : cs.labels) {
+        for (auto label : l.second) {
+            labelPos[label] = l.first;
+            if (used.count(label))
+                targets.insert(l.first);
+        }
+    }
+}
+
+// Lets the jump at pc go straight to the end of a chain of unconditional
+// jumps. Gives up on cycles, those are infinite loops anyway.
+bool Peephole::threadJump(unsigned pc) {
+    auto label = cs.patchpoints.at(pc + 1);
+    std::unordered_set<unsigned> seen = {pc};
+    while (true) {
+        auto t = skipNops(labelPos.at(label));
+        if (t >= cs.pos || *at(t) != Opcode::br_)
+            break;
+        if (seen.count(t))
+            return false;
+        seen.insert(t);
+        label = cs.patchpoints.at(t + 1);
+    }
+    if (label == cs.patchpoints.at(pc + 1))
+        return false;
+    cs.patchpoints[pc + 1] = label;
+    targets.insert(labelPos.at(label));
+    return true;
+}
+
+void Peephole::replaceJumpByRet(unsigned pc) {
+    assert(*at(pc) == Opcode::br_);
+    *at(pc) = Opcode::ret_;
+    cs.patchpoints.erase(pc + 1);
+    for (unsigned i = 1; i < BC::fixedSize(Opcode::br_); ++i) {
+        *at(pc + i) = Opcode::nop_;
+        cs.nops++;
+    }
+}
+
+bool Peephole::round() {
+    analyze();
+    bool changed = false;
+
+    // The instruction after instrs[i], if it can only be reached from there
+    auto next = [&](size_t i) -> Opcode* {
+        if (i + 1 >= instrs.size() || entered(instrs[i], instrs[i + 1]))
+            return nullptr;
+        return at(instrs[i + 1]);
+    };
+
+    for (size_t i = 0; i < instrs.size(); ++i) {
+        auto pc = instrs[i];
+        auto following = next(i);
+
+        // Values which are dropped right away
+        if ((*at(pc) == Opcode::dup_ || *at(pc) == Opcode::push_) &&
+            following && *following == Opcode::pop_) {
+            cs.remove(pc);
+            cs.remove(instrs[++i]);
+            changed = true;
+            continue;
+        }
+
+        // Visibility which is overwritten before anyone can observe it
+        if (isVisibility(*at(pc)) && following && isVisibility(*following)) {
+            cs.remove(pc);
+            changed = true;
+            continue;
+        }
+
+        // Branches on a constant condition
+        bool cond;
+        if (*at(pc) == Opcode::push_ && following &&
+            isConstantCondition(pc, cond)) {
+            // Constants set the visibility, and if records its condition
+            // before the asbool_
+            auto j = i + 1;
+            while (following && (isVisibility(*following) ||
+                                 *following == Opcode::record_test_ ||
+                                 *following == Opcode::asbool_))
+                following = next(j++);
+            if (following && *following != Opcode::br_ &&
+                isBranch(*following)) {
+                auto jmp = instrs[j];
+                bool taken = *following == Opcode::brfalse_ ? !cond : cond;
+                for (auto k = i; k < j; ++k)
+                    if (!isVisibility(*at(instrs[k])))
+                        cs.remove(instrs[k]);
+                if (taken) {
+                    *at(jmp) = Opcode::br_;
+                    cs.sources.erase(jmp + BC::fixedSize(Opcode::br_));
+                } else {
+                    cs.remove(jmp);
+                }
+                i = j;
+                changed = true;
+                continue;
+            }
+        }
+
+        if (isBranch(*at(pc))) {
+            if (threadJump(pc))
+                changed = true;
+            if (*at(pc) == Opcode::br_) {
+                auto t = skipNops(labelPos.at(cs.patchpoints.at(pc + 1)));
+                if (i + 1 < instrs.size() && t == instrs[i + 1]) {
+                    cs.remove(pc);
+                    changed = true;
+                    continue;
+                }
+                if (t < cs.pos && *at(t) == Opcode::ret_) {
+                    replaceJumpByRet(pc);
+                    changed = true;
+                }
+            }
+        }
+
+        // Nothing falls through into the code after a jump or a return, it
+        // is unreachable up to the next jump target
+        if (*at(pc) == Opcode::br_ || *at(pc) == Opcode::ret_ ||
+            *at(pc) == Opcode::return_) {
+            while (i + 1 < instrs.size() && !entered(pc, instrs[i + 1])) {
+                cs.remove(instrs[++i]);
+                changed = true;
+            }
+        }
+    }
+    return changed;
+}
+
+void Peephole::optimize(CodeStream& cs) {
+    Peephole p(cs);
+    while (p.round()) {
+    }
+}
+
+} // namespace rir
@@ -0,0 +1,51 @@
+#ifndef RIR_PEEPHOLE_H
+#define RIR_PEEPHOLE_H
+
+#include "bc/BC_inc.h"
+
+#include <set>
+#include <unordered_map>
+#include <vector>
+
+namespace rir {
+
+class CodeStream;
+
+/** Cleans up the bytecode in a CodeStream before it is finalized.
+ *
+ * Removes values which are pushed and dropped right away, visibility changes
+ * which are overwritten before anyone can observe them, branches on constant
+ * conditions, jumps to jumps and unreachable code. Instructions are only ever
+ * replaced by nops, so record_* instructions keep their feedback and sources
+ * stay attached to the instructions they belong to.
+ */
+class Peephole {
+  public:
+    static void optimize(CodeStream& cs);
+
+  private:
+    explicit Peephole(CodeStream& cs) : cs(cs) {}
+
+    CodeStream& cs;
+    // Start of every instruction which is not a nop
+    std::vector<unsigned> instrs;
+    // Positions of labels, which are the target of some jump
+    std::set<unsigned> targets;
+    std::unordered_map<BC::Label, unsigned> labelPos;
+
+    Opcode* at(unsigned pc) const;
+    unsigned skipNops(unsigned pc) const;
+    // Is there a jump target between the instructions from and to (excluded
+    // and included respectively)?
+    bool entered(unsigned from, unsigned to) const;
+    bool isConstantCondition(unsigned pc, bool& value) const;
+
+    void analyze();
+    bool threadJump(unsigned pc);
+    void replaceJumpByRet(unsigned pc);
+    bool round();
+};
+
+} // namespace rir
+
+#endif
@@ -84,16 +84,19 @@ DEF_INSTR(stvar_super_, 1, 1, 0)
  * call_:: Call instruction. Takes n arguments on the stack
  *         on top of the callee; these arguments can be
  *         values, promises (even preseeded w/ a value), or R_MissingValue for
- *         explicitly missing arguments.
+ *         explicitly missing arguments. The last 4 immediates cache the
+ *         inferred call context (see BC::CallContextCache).
  */
-DEF_INSTR(call_, 4, -1, 1)
+DEF_INSTR(call_, 8, -1, 1)
 
 /*
  * named_call_:: Same as above, but with names for the arguments as immediates
  *               THIS IS A VARIABLE LENGTH INSTRUCTION
- *               the actual number of immediates is 3 + nargs
+ *               the actual number of immediates is 8 + nargs, the names are
+ *               followed by an argument matching cache
+ *               (see BC::CallArgmatchCache).
  */
-DEF_INSTR(named_call_, 4, -1, 1)
+DEF_INSTR(named_call_, 8, -1, 1)
 
 /*
  * call_dots_:: This instruction is like named_call_, but additionally it
@@ -285,6 +288,12 @@ DEF_INSTR(brtrue_, 1, 1, 0)
  */
 DEF_INSTR(brfalse_, 1, 1, 0)
 
+/**
+ * asbool_brtrue_:: superinstruction for asbool_ followed by brtrue_, as
+ * emitted for the condition of every if. CodeStream fuses the two.
+ */
+DEF_INSTR(asbool_brtrue_, 1, 1, 0)
+
 /**
  * br_:: branch to immediate offset
  */
@@ -129,6 +129,27 @@ static void lower(Module* module, ClosureVersion* cls, Code* code,
         }
     });
 
+    // Contexts are only targeted by longjmps through their cloenv, which is
+    // set by the environments created for them. Environments only created on
+    // deopt do not count, deoptimization sets up a fresh jmpbuf.
+    std::unordered_set<PushContext*> needsLongjmp;
+    Visitor::run(code->entry, [&](BB* bb) {
+        if (bb->isDeopt())
+            return;
+        for (auto i : *bb) {
+            if (auto mk = MkEnv::Cast(i)) {
+                auto state = cs.before(mk);
+                auto& stack = state.contextStack;
+                if (mk->context > 0 && (size_t)mk->context <= stack.size())
+                    needsLongjmp.insert(stack[stack.size() - mk->context]);
+            }
+        }
+    });
+    Visitor::run(code->entry, [&](Instruction* i) {
+        if (auto push = PushContext::Cast(i))
+            push->lightweight = !needsLongjmp.count(push);
+    });
+
     Visitor::runPostChange(code->entry, [&](BB* bb) {
         auto it = bb->begin();
         while (it != bb->end()) {
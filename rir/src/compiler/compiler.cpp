@@ -372,6 +372,8 @@ void Compiler::optimizeModule() {
                 auto pirLog = clog.forPass(passnr, translation->getName());
                 pirLog.pirOptimizationsHeader(translation);
 
+                if (beforePass)
+                    beforePass(translation, v);
                 if (MEASURE_COMPILER_PERF)
                     Measuring::startTimer("compiler.cpp: " +
                                           translation->getName());
@@ -381,6 +383,8 @@ void Compiler::optimizeModule() {
                 if (MEASURE_COMPILER_PERF)
                     Measuring::countTimer("compiler.cpp: " +
                                           translation->getName());
+                if (afterPass)
+                    afterPass(translation, v);
 
                 pirLog.pirOptimizations(translation);
                 pirLog.flush();
@@ -15,6 +15,7 @@ namespace rir {
 struct DispatchTable;
 namespace pir {
 struct DeoptContext;
+class Pass;
 
 class Compiler {
   public:
@@ -46,6 +47,10 @@ class Compiler {
     void optimizeModule();
     void optimizeClosureVersion(ClosureVersion*);
 
+    // Called around every application of a pass in optimizeModule
+    typedef std::function<void(const Pass*, ClosureVersion*)> PassHook;
+    PassHook beforePass, afterPass;
+
     bool seenC = false;
 
     void preserve(SEXP c) { preserve_(c); }
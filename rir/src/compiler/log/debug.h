@@ -20,6 +20,7 @@ namespace pir {
     V(PrintCSSA)                                                               \
     V(PrintLLVM)                                                               \
     V(PrintAllocator)                                                          \
+    V(PrintInliner)                                                            \
     V(PrintFinalPir)
 
 #define LIST_OF_PIR_DEBUGGING_FLAGS(V)                                         \
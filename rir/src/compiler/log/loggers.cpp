@@ -148,6 +148,13 @@ void AbstractLog::warn(const std::string& msg) {
     }
 }
 
+void AbstractLog::inlining(const std::string& msg) {
+    if (options.includes(DebugFlag::PrintInliner)) {
+        preparePrint();
+        out() << "Inliner: " << msg << " in " << version->name() << "\n";
+    }
+}
+
 void AbstractLog::failed(const std::string& msg) {
     if (options.includes(DebugFlag::ShowWarnings)) {
         preparePrint();
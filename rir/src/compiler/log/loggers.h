@@ -47,6 +47,7 @@ class AbstractLog {
     void section(const std::string&);
     void failed(const std::string& msg);
     void warn(const std::string& msg);
+    void inlining(const std::string& msg);
 };
 
 class ClosureLog;
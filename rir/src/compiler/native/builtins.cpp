@@ -330,10 +330,12 @@ static SEXP callImpl(ArglistOrder::CallId callId, rir::Code* c, Immediate ast,
 
 static SEXP namedCallImpl(ArglistOrder::CallId callId, rir::Code* c,
                           Immediate ast, SEXP callee, SEXP env, size_t nargs,
-                          Immediate* names, unsigned long available) {
+                          Immediate* names, BC::CallArgmatchCache* argmatch,
+                          unsigned long available) {
     CallContext call(callId, c, callee, nargs, ast,
                      ostack_cell_at((long)nargs - 1), names, env, R_NilValue,
                      Context(available));
+    call.argmatchCache = argmatch;
     SLOWASSERT(env == symbol::delayedEnv || TYPEOF(env) == ENVSXP ||
                LazyEnvironment::check(env));
     return doCall(call, true);
@@ -808,7 +810,8 @@ int asLogicalImpl(SEXP a) {
 
 int lengthImpl(SEXP e) { return Rf_length(e); }
 
-std::vector<BC::PoolIdx> NativeBuiltins::targetCaches;
+std::unordered_set<BC::PoolIdx> NativeBuiltins::targetCaches;
+size_t NativeBuiltins::deopts = 0;
 
 // An empty function that is marked as deoptimized to use as sentinel e.g. in
 // invalidated caches.
@@ -830,7 +833,13 @@ static SEXP deoptSentinelContainer = []() {
 
 void deoptImpl(rir::Code* c, SEXP cls, DeoptMetadata* m, R_bcstack_t* args,
                bool leakedEnv, DeoptReason* deoptReason, SEXP deoptTrigger) {
+    NativeBuiltins::deopts++;
     deoptReason->record(deoptTrigger);
+    // The failing assumption might be in inlined code, the outer function
+    // continues in its baseline as well
+    if (TYPEOF(cls) == CLOSXP)
+        if (auto dt = DispatchTable::check(BODY(cls)))
+            dt->baseline()->unfreezeFeedback();
 
     assert(m->numFrames >= 1);
     size_t stackHeight = 0;
@@ -938,12 +947,39 @@ void deoptImpl(rir::Code* c, SEXP cls, DeoptMetadata* m, R_bcstack_t* args,
         }
     }
 
+    // Failing assumption in inlined code, resume every inlined frame with
+    // its own continuation.
+    if (deoptless && m->numFrames > 1 && cls != deoptlessRecursion) {
+        CallContext call(ArglistOrder::NOT_REORDERED, c, cls,
+                         /* nargs */ -1, src_pool_at(c->src), args,
+                         (Immediate*)nullptr, env, R_NilValue, Context());
+        RCNTXT* outerCntxt = nullptr;
+        deoptlessRecursion = cls;
+        auto res = deoptlessInlinedFrames(c, call, m, *deoptReason,
+                                          deoptTrigger, &outerCntxt);
+        deoptlessRecursion = nullptr;
+        if (res) {
+            Rf_findcontext(CTXT_BROWSER | CTXT_FUNCTION, outerCntxt->cloenv,
+                           res);
+            assert(false);
+            return;
+        }
+    }
+
     c->function()->registerDeopt();
-    // Invalidate target caches pointing to deoptimized version
-    for (auto idx : NativeBuiltins::targetCaches)
-        if (auto f = Function::check(Pool::get(idx)))
+    // Invalidate target caches pointing to deoptimized version and forget
+    // the ones whose code was collected
+    auto& caches = NativeBuiltins::targetCaches;
+    for (auto idx = caches.begin(); idx != caches.end();) {
+        if (!Pool::isPatchable(*idx)) {
+            idx = caches.erase(idx);
+            continue;
+        }
+        if (auto f = Function::check(Pool::get(*idx)))
             if (f->body() == c)
-                Pool::patch(idx, deoptSentinelContainer);
+                Pool::patch(*idx, deoptSentinelContainer);
+        idx++;
+    }
 
     CallContext call(ArglistOrder::NOT_REORDERED, c, cls,
                      /* nargs */ -1, src_pool_at(c->src), args,
@@ -1304,6 +1340,10 @@ static void endClosureContext(RCNTXT* cntxt, SEXP result) {
     Rf_endcontext(cntxt);
 }
 
+static SEXP nativeCallTrampolineEnter(CallContext& call, Function* fun,
+                                      SEXP callee, Immediate astP, SEXP env,
+                                      size_t nargs);
+
 static SEXP nativeCallTrampolineImpl(ArglistOrder::CallId callId, rir::Code* c,
                                      SEXP callee, Immediate target,
                                      Immediate astP, SEXP env, size_t nargs,
@@ -1429,6 +1469,31 @@ static SEXP nativeCallTrampolineImpl(ArglistOrder::CallId callId, rir::Code* c,
         }
     }
 
+    return nativeCallTrampolineEnter(call, fun, callee, astP, env, nargs);
+}
+
+// Calls the function currently executing again, skipping dispatch.
+// The caller statically checked that the given context is compatible
+// with the one this version was compiled for.
+static SEXP nativeSelfCallImpl(ArglistOrder::CallId callId, rir::Code* c,
+                               SEXP callee, Immediate astP, SEXP env,
+                               size_t nargs, unsigned long available) {
+    auto fun = c->function();
+    CallContext call(callId, c, callee, nargs, astP,
+                     ostack_cell_at((long)nargs - 1), env, R_NilValue,
+                     Context(available));
+
+    fun->registerInvocation();
+    if (fun->disabled()) {
+        fun->unregisterInvocation();
+        return doCall(call, true);
+    }
+    return nativeCallTrampolineEnter(call, fun, callee, astP, env, nargs);
+}
+
+static SEXP nativeCallTrampolineEnter(CallContext& call, Function* fun,
+                                      SEXP callee, Immediate astP, SEXP env,
+                                      size_t nargs) {
     R_CheckStack();
 #ifdef ENABLE_SLOWASSERT
     auto t = R_BCNodeStackTop;
@@ -2351,7 +2416,7 @@ void NativeBuiltins::initializeBuiltins() {
         "namedCall", (void*)&namedCallImpl,
         llvm::FunctionType::get(t::SEXP,
                                 {t::i64, t::voidPtr, t::Int, t::SEXP, t::SEXP,
-                                 t::i64, t::IntPtr, t::i64},
+                                 t::i64, t::IntPtr, t::voidPtr, t::i64},
                                 false)};
     get_(Id::dotsCall) = {
         "dotsCall", (void*)&dotsCallImpl,
@@ -2484,6 +2549,11 @@ void NativeBuiltins::initializeBuiltins() {
                                 {t::i64, t::voidPtr, t::SEXP, t::Int, t::Int,
                                  t::SEXP, t::i64, t::i64, t::Int},
                                 false)};
+    get_(Id::nativeSelfCall) = {
+        "nativeSelfCall", (void*)&nativeSelfCallImpl,
+        llvm::FunctionType::get(
+            t::SEXP, {t::i64, t::voidPtr, t::SEXP, t::Int, t::SEXP, t::i64, t::i64},
+            false)};
     get_(Id::subassign11) = {
         "subassign1_1D", (void*)subassign11Impl,
         llvm::FunctionType::get(
@@ -9,6 +9,7 @@
 
 #include <cstddef>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 extern "C" {
@@ -99,6 +100,7 @@ struct NativeBuiltins {
         extract22ii,
         extract22rr,
         nativeCallTrampoline,
+        nativeSelfCall,
         subassign11,
         setVecElt,
         subassign21,
@@ -159,7 +161,9 @@ struct NativeBuiltins {
 
     static void initializeBuiltins();
 
-    static std::vector<BC::PoolIdx> targetCaches;
+    static std::unordered_set<BC::PoolIdx> targetCaches;
+    // Number of deopts so far, including deoptless ones
+    static size_t deopts;
 
   private:
     // For setting up - returns mutable reference
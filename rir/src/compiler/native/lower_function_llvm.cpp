@@ -236,22 +236,30 @@ llvm::Value* LowerFunctionLLVM::constant(SEXP co, const Rep& needed) {
         eternalConst.count(co))
         return convertToPointer(co, true);
 
-    auto i = Pool::insert(co);
+    BC::PoolIdx i;
+    auto owned = ownedConstants.find(co);
+    if (owned != ownedConstants.end()) {
+        i = owned->second;
+    } else if (!Pool::interned(co, i)) {
+        i = Pool::insertOwned(co, target);
+        ownedConstants.emplace(co, i);
+    }
     llvm::Value* pos = builder.CreateLoad(constantpool);
     pos = builder.CreateBitCast(dataPtr(pos, false),
                                 PointerType::get(t::SEXP, 0));
     pos = builder.CreateGEP(pos, c(i));
-    return builder.CreateLoad(pos);
+    return tbaa::annotate(builder.CreateLoad(pos), tbaa::sexpData);
 }
 
 llvm::Value* LowerFunctionLLVM::nodestackPtr() {
-    return builder.CreateLoad(nodestackPtrAddr);
+    return tbaa::annotate(builder.CreateLoad(nodestackPtrAddr),
+                          tbaa::nodeStackTop);
 }
 
 llvm::Value* LowerFunctionLLVM::stack(int i) {
     auto offset = -(i + 1);
     auto pos = builder.CreateGEP(nodestackPtr(), {c(offset), c(2)});
-    return builder.CreateLoad(t::SEXP, pos);
+    return tbaa::annotate(builder.CreateLoad(t::SEXP, pos), tbaa::nodeStack);
 }
 
 void LowerFunctionLLVM::stack(const std::vector<llvm::Value*>& args) {
@@ -264,7 +272,7 @@ void LowerFunctionLLVM::stack(const std::vector<llvm::Value*>& args) {
     for (auto arg = args.begin(); arg != args.end(); arg++) {
         // store the value
         auto valS = builder.CreateGEP(stackptr, {c(pos), c(2)});
-        builder.CreateStore(*arg, valS);
+        tbaa::annotate(builder.CreateStore(*arg, valS), tbaa::nodeStack);
         pos++;
     }
     assert(pos == 0);
@@ -273,7 +281,7 @@ void LowerFunctionLLVM::stack(const std::vector<llvm::Value*>& args) {
 void LowerFunctionLLVM::setLocal(size_t i, llvm::Value* v) {
     assert(v->getType() == t::SEXP);
     auto pos = builder.CreateGEP(basepointer, {c(i), c(2)});
-    builder.CreateStore(v, pos, true);
+    tbaa::annotate(builder.CreateStore(v, pos, true), tbaa::nodeStack);
 }
 
 void LowerFunctionLLVM::incStack(int i, bool zero) {
@@ -285,7 +293,8 @@ void LowerFunctionLLVM::incStack(int i, bool zero) {
         builder.CreateMemSet(cur, c(0, 8), offset,
                              MaybeAlign(alignof(R_bcstack_t)));
     auto up = builder.CreateGEP(cur, c(i));
-    builder.CreateStore(up, nodestackPtrAddr);
+    tbaa::annotate(builder.CreateStore(up, nodestackPtrAddr),
+                   tbaa::nodeStackTop);
 }
 
 void LowerFunctionLLVM::decStack(int i) {
@@ -293,7 +302,8 @@ void LowerFunctionLLVM::decStack(int i) {
         return;
     auto cur = nodestackPtr();
     auto up = builder.CreateGEP(cur, c(-i));
-    builder.CreateStore(up, nodestackPtrAddr);
+    tbaa::annotate(builder.CreateStore(up, nodestackPtrAddr),
+                   tbaa::nodeStackTop);
 }
 
 llvm::Value* LowerFunctionLLVM::callRBuiltin(SEXP builtin,
@@ -622,6 +632,11 @@ void LowerFunctionLLVM::compilePushContext(Instruction* i) {
         },
         false);
 
+    // The context is only there for sys.function and friends, nobody will
+    // jump to it.
+    if (ct->lightweight)
+        return;
+
     // Create a copy of all live variables to be able to restart
     // SEXPs are stored as local vars, primitive values are placed in an
     // alloca'd buffer
@@ -765,7 +780,9 @@ llvm::Value* LowerFunctionLLVM::vectorPositionPtr(llvm::Value* vector,
 llvm::Value* LowerFunctionLLVM::accessVector(llvm::Value* vector,
                                              llvm::Value* position,
                                              PirType type) {
-    return builder.CreateLoad(vectorPositionPtr(vector, position, type));
+    auto pos = vectorPositionPtr(vector, position, type);
+    return tbaa::annotate(builder.CreateLoad(pos),
+                          tbaa::vectorData(pos->getType()));
 }
 
 llvm::Value* LowerFunctionLLVM::assignVector(llvm::Value* vector,
@@ -775,15 +792,16 @@ llvm::Value* LowerFunctionLLVM::assignVector(llvm::Value* vector,
     insn_assert(builder.CreateNot(shared(vector)),
                 "assigning to shared vector");
 #endif
-    return builder.CreateStore(value,
-                               vectorPositionPtr(vector, position, type));
+    auto pos = vectorPositionPtr(vector, position, type);
+    return tbaa::annotate(builder.CreateStore(value, pos),
+                          tbaa::vectorData(pos->getType()));
 }
 
 llvm::Value* LowerFunctionLLVM::unboxIntLgl(llvm::Value* v) {
     assert(v->getType() == t::SEXP);
     checkSexptype(v, {LGLSXP, INTSXP});
     auto pos = builder.CreateBitCast(dataPtr(v), t::IntPtr);
-    return builder.CreateLoad(pos);
+    return tbaa::annotate(builder.CreateLoad(pos), tbaa::intData);
 }
 
 llvm::Value* LowerFunctionLLVM::unboxInt(llvm::Value* v) {
@@ -792,7 +810,7 @@ llvm::Value* LowerFunctionLLVM::unboxInt(llvm::Value* v) {
     insn_assert(isSimpleScalar(v, INTSXP), "expected scalar int");
 #endif
     auto pos = builder.CreateBitCast(dataPtr(v), t::IntPtr);
-    return builder.CreateLoad(pos);
+    return tbaa::annotate(builder.CreateLoad(pos), tbaa::intData);
 }
 
 llvm::Value* LowerFunctionLLVM::unboxLgl(llvm::Value* v) {
@@ -801,7 +819,7 @@ llvm::Value* LowerFunctionLLVM::unboxLgl(llvm::Value* v) {
     insn_assert(isSimpleScalar(v, LGLSXP), "expected scalar lgl");
 #endif
     auto pos = builder.CreateBitCast(dataPtr(v), t::IntPtr);
-    auto unbox = builder.CreateLoad(pos);
+    auto unbox = tbaa::annotate(builder.CreateLoad(pos), tbaa::intData);
     // Normalize the unboxed lgl to 0,1,NA.
     return builder.CreateSelect(
         builder.CreateICmpEQ(unbox, c(0)), c(0),
@@ -815,7 +833,7 @@ llvm::Value* LowerFunctionLLVM::unboxReal(llvm::Value* v) {
     insn_assert(isSimpleScalar(v, REALSXP), "expected scalar real");
 #endif
     auto pos = builder.CreateBitCast(dataPtr(v), t::DoublePtr);
-    auto res = builder.CreateLoad(pos);
+    auto res = tbaa::annotate(builder.CreateLoad(pos), tbaa::realData);
     return res;
 }
 
@@ -873,7 +891,8 @@ llvm::Value* LowerFunctionLLVM::argument(int i) {
     insn_assert(builder.CreateIsNotNull(builder.CreateLoad(pos)), "null arg");
 #endif
 
-    loadedArgs.at(i) = builder.CreateLoad(pos);
+    loadedArgs.at(i) =
+        tbaa::annotate(builder.CreateLoad(pos), tbaa::nodeStack);
     entryBlock = builder.GetInsertBlock();
     builder.SetInsertPoint(cur);
 
@@ -990,15 +1009,17 @@ llvm::Value* LowerFunctionLLVM::sxpinfoPtr(llvm::Value* v) {
 
 void LowerFunctionLLVM::setSexptype(llvm::Value* v, int t) {
     auto ptr = sxpinfoPtr(v);
-    llvm::Value* sxpinfo = builder.CreateLoad(ptr);
+    llvm::Value* sxpinfo =
+        tbaa::annotate(builder.CreateLoad(ptr), tbaa::sxpinfo);
     sxpinfo =
         builder.CreateAnd(sxpinfo, c(~((unsigned long)(MAX_NUM_SEXPTYPE - 1))));
     sxpinfo = builder.CreateOr(sxpinfo, c(t, 64));
-    builder.CreateStore(sxpinfo, ptr);
+    tbaa::annotate(builder.CreateStore(sxpinfo, ptr), tbaa::sxpinfo);
 }
 
 llvm::Value* LowerFunctionLLVM::sexptype(llvm::Value* v) {
-    auto sxpinfo = builder.CreateLoad(sxpinfoPtr(v));
+    auto sxpinfo =
+        tbaa::annotate(builder.CreateLoad(sxpinfoPtr(v)), tbaa::sxpinfo);
     auto t = builder.CreateAnd(sxpinfo, c(MAX_NUM_SEXPTYPE - 1, 64));
     return builder.CreateTrunc(t, t::Int);
 }
@@ -1070,24 +1091,24 @@ llvm::Value* LowerFunctionLLVM::isArray(llvm::Value* v) {
 
 llvm::Value* LowerFunctionLLVM::car(llvm::Value* v) {
     v = builder.CreateGEP(v, {c(0), c(4), c(0)});
-    return builder.CreateLoad(v);
+    return tbaa::annotate(builder.CreateLoad(v), tbaa::car);
 }
 
 llvm::Value* LowerFunctionLLVM::cdr(llvm::Value* v) {
     v = builder.CreateGEP(v, {c(0), c(4), c(1)});
-    return builder.CreateLoad(v);
+    return tbaa::annotate(builder.CreateLoad(v), tbaa::cdr);
 }
 
 llvm::Value* LowerFunctionLLVM::tag(llvm::Value* v) {
     v = builder.CreateGEP(v, {c(0), c(4), c(2)});
-    return builder.CreateLoad(v);
+    return tbaa::annotate(builder.CreateLoad(v), tbaa::tag);
 }
 
 void LowerFunctionLLVM::setCar(llvm::Value* x, llvm::Value* y,
                                bool needsWriteBarrier) {
     auto fast = [&]() {
         auto xx = builder.CreateGEP(x, {c(0), c(4), c(0)});
-        builder.CreateStore(y, xx);
+        tbaa::annotate(builder.CreateStore(y, xx), tbaa::car);
     };
     if (!needsWriteBarrier) {
         fast();
@@ -1110,7 +1131,7 @@ void LowerFunctionLLVM::setCdr(llvm::Value* x, llvm::Value* y,
                                bool needsWriteBarrier) {
     auto fast = [&]() {
         auto xx = builder.CreateGEP(x, {c(0), c(4), c(1)});
-        builder.CreateStore(y, xx);
+        tbaa::annotate(builder.CreateStore(y, xx), tbaa::cdr);
     };
     if (!needsWriteBarrier) {
         fast();
@@ -1133,7 +1154,7 @@ void LowerFunctionLLVM::setTag(llvm::Value* x, llvm::Value* y,
                                bool needsWriteBarrier) {
     auto fast = [&]() {
         auto xx = builder.CreateGEP(x, {c(0), c(4), c(2)});
-        builder.CreateStore(y, xx);
+        tbaa::annotate(builder.CreateStore(y, xx), tbaa::tag);
     };
     if (!needsWriteBarrier) {
         fast();
@@ -1146,18 +1167,19 @@ void LowerFunctionLLVM::setTag(llvm::Value* x, llvm::Value* y,
 
 llvm::Value* LowerFunctionLLVM::attr(llvm::Value* v) {
     auto pos = builder.CreateGEP(v, {c(0), c(1)});
-    return builder.CreateLoad(pos);
+    return tbaa::annotate(builder.CreateLoad(pos), tbaa::attrib);
 }
 
 llvm::Value* LowerFunctionLLVM::isScalar(llvm::Value* v) {
     auto va = builder.CreateBitCast(v, t::VECTOR_SEXPREC_ptr);
     auto lp = builder.CreateGEP(va, {c(0), c(4), c(0)});
-    auto l = builder.CreateLoad(lp);
+    auto l = tbaa::annotate(builder.CreateLoad(lp), tbaa::vectorLength);
     return builder.CreateICmpEQ(l, c(1, 64));
 }
 
 llvm::Value* LowerFunctionLLVM::isSimpleScalar(llvm::Value* v, SEXPTYPE t) {
-    auto sxpinfo = builder.CreateLoad(sxpinfoPtr(v));
+    auto sxpinfo =
+        tbaa::annotate(builder.CreateLoad(sxpinfoPtr(v)), tbaa::sxpinfo);
 
     auto type = builder.CreateAnd(sxpinfo, c(MAX_NUM_SEXPTYPE - 1, 64));
     auto okType = builder.CreateICmpEQ(c(t), builder.CreateTrunc(type, t::Int));
@@ -1178,12 +1200,12 @@ llvm::Value* LowerFunctionLLVM::vectorLength(llvm::Value* v) {
     assert(v->getType() == t::SEXP);
     auto pos = builder.CreateBitCast(v, t::VECTOR_SEXPREC_ptr);
     pos = builder.CreateGEP(pos, {c(0), c(4), c(0)});
-    return builder.CreateLoad(pos);
+    return tbaa::annotate(builder.CreateLoad(pos), tbaa::vectorLength);
 }
 
 llvm::Value* LowerFunctionLLVM::isNamed(llvm::Value* v) {
     auto sxpinfoP = builder.CreateBitCast(sxpinfoPtr(v), t::i64ptr);
-    auto sxpinfo = builder.CreateLoad(sxpinfoP);
+    auto sxpinfo = tbaa::annotate(builder.CreateLoad(sxpinfoP), tbaa::sxpinfo);
 
     static auto namedMask = ((unsigned long)pow(2, NAMED_BITS) - 1) << 32;
     auto named = builder.CreateAnd(sxpinfo, c(namedMask));
@@ -1193,7 +1215,7 @@ llvm::Value* LowerFunctionLLVM::isNamed(llvm::Value* v) {
 void LowerFunctionLLVM::assertNamed(llvm::Value* v) {
     assert(v->getType() == t::SEXP);
     auto sxpinfoP = builder.CreateBitCast(sxpinfoPtr(v), t::i64ptr);
-    auto sxpinfo = builder.CreateLoad(sxpinfoP);
+    auto sxpinfo = tbaa::annotate(builder.CreateLoad(sxpinfoP), tbaa::sxpinfo);
 
     static auto namedMask = ((unsigned long)pow(2, NAMED_BITS) - 1) << 32;
     auto named = builder.CreateAnd(sxpinfo, c(namedMask));
@@ -1215,7 +1237,7 @@ void LowerFunctionLLVM::assertNamed(llvm::Value* v) {
 llvm::Value* LowerFunctionLLVM::shared(llvm::Value* v) {
     assert(v->getType() == t::SEXP);
     auto sxpinfoP = builder.CreateBitCast(sxpinfoPtr(v), t::i64ptr);
-    auto sxpinfo = builder.CreateLoad(sxpinfoP);
+    auto sxpinfo = tbaa::annotate(builder.CreateLoad(sxpinfoP), tbaa::sxpinfo);
 
     static auto namedMask = ((unsigned long)pow(2, NAMED_BITS) - 1);
     auto named = builder.CreateLShr(sxpinfo, c(32ul));
@@ -1256,7 +1278,7 @@ void LowerFunctionLLVM::ensureNamedIfNeeded(Instruction* i, llvm::Value* val) {
 void LowerFunctionLLVM::ensureNamed(llvm::Value* v) {
     assert(v->getType() == t::SEXP);
     auto sxpinfoP = builder.CreateBitCast(sxpinfoPtr(v), t::i64ptr);
-    auto sxpinfo = builder.CreateLoad(sxpinfoP);
+    auto sxpinfo = tbaa::annotate(builder.CreateLoad(sxpinfoP), tbaa::sxpinfo);
 
     static auto namedMask = ((unsigned long)pow(2, NAMED_BITS) - 1) << 32;
     unsigned long namedLSB = 1ul << 32;
@@ -1272,7 +1294,8 @@ void LowerFunctionLLVM::ensureNamed(llvm::Value* v) {
 
     builder.SetInsertPoint(notNamed);
     auto namedSxpinfo = builder.CreateOr(sxpinfo, c(namedLSB));
-    builder.CreateStore(namedSxpinfo, sxpinfoP);
+    tbaa::annotate(builder.CreateStore(namedSxpinfo, sxpinfoP),
+                   tbaa::sxpinfo);
     builder.CreateBr(ok);
 
     builder.SetInsertPoint(ok);
@@ -1281,7 +1304,7 @@ void LowerFunctionLLVM::ensureNamed(llvm::Value* v) {
 void LowerFunctionLLVM::ensureShared(llvm::Value* v) {
     assert(v->getType() == t::SEXP);
     auto sxpinfoP = sxpinfoPtr(v);
-    auto sxpinfo = builder.CreateLoad(sxpinfoP);
+    auto sxpinfo = tbaa::annotate(builder.CreateLoad(sxpinfoP), tbaa::sxpinfo);
 
     static auto namedMask = ((unsigned long)pow(2, NAMED_BITS) - 1);
     static auto namedNegMask = ~(namedMask << 32);
@@ -1301,7 +1324,7 @@ void LowerFunctionLLVM::ensureShared(llvm::Value* v) {
 
     auto newSxpinfo = builder.CreateAnd(sxpinfo, c(namedNegMask));
     newSxpinfo = builder.CreateOr(newSxpinfo, newNamed);
-    builder.CreateStore(newSxpinfo, sxpinfoP);
+    tbaa::annotate(builder.CreateStore(newSxpinfo, sxpinfoP), tbaa::sxpinfo);
     builder.CreateBr(done);
 
     builder.SetInsertPoint(done);
@@ -1310,7 +1333,7 @@ void LowerFunctionLLVM::ensureShared(llvm::Value* v) {
 void LowerFunctionLLVM::incrementNamed(llvm::Value* v, int max) {
     assert(v->getType() == t::SEXP);
     auto sxpinfoP = sxpinfoPtr(v);
-    auto sxpinfo = builder.CreateLoad(sxpinfoP);
+    auto sxpinfo = tbaa::annotate(builder.CreateLoad(sxpinfoP), tbaa::sxpinfo);
 
     static auto namedMask = ((unsigned long)pow(2, NAMED_BITS) - 1);
     static auto namedNegMask = ~(namedMask << 32);
@@ -1331,7 +1354,7 @@ void LowerFunctionLLVM::incrementNamed(llvm::Value* v, int max) {
 
     auto newSxpinfo = builder.CreateAnd(sxpinfo, c(namedNegMask));
     newSxpinfo = builder.CreateOr(newSxpinfo, newNamed);
-    builder.CreateStore(newSxpinfo, sxpinfoP);
+    tbaa::annotate(builder.CreateStore(newSxpinfo, sxpinfoP), tbaa::sxpinfo);
     builder.CreateBr(done);
 
     builder.SetInsertPoint(done);
@@ -1425,7 +1448,44 @@ llvm::Value* LowerFunctionLLVM::container(llvm::Value* v) {
 
 llvm::CallInst* LowerFunctionLLVM::call(const NativeBuiltin& builtin,
                                         const std::vector<llvm::Value*>& args) {
-    return builder.CreateCall(getBuiltin(builtin), args);
+    auto res = builder.CreateCall(getBuiltin(builtin), args);
+    if (coldBlocks.count(builder.GetInsertBlock()))
+        res->addAttribute(llvm::AttributeList::FunctionIndex,
+                          llvm::Attribute::Cold);
+    return res;
+}
+
+llvm::BasicBlock* LowerFunctionLLVM::coldBlock() {
+    auto bb = BasicBlock::Create(PirJitLLVM::getContext(), "", fun);
+    coldBlocks.insert(bb);
+    return bb;
+}
+
+void LowerFunctionLLVM::jumpToDeoptTrampoline(llvm::Value* metadata,
+                                              llvm::Value* escapedEnv,
+                                              llvm::Value* reason,
+                                              llvm::Value* trigger) {
+    auto& t = deoptTrampoline;
+    if (!t.block) {
+        auto cur = builder.GetInsertBlock();
+        t.block = coldBlock();
+        builder.SetInsertPoint(t.block);
+        t.metadata = builder.CreatePHI(metadata->getType(), 2);
+        t.escapedEnv = builder.CreatePHI(escapedEnv->getType(), 2);
+        t.reason = builder.CreatePHI(reason->getType(), 2);
+        t.trigger = builder.CreatePHI(trigger->getType(), 2);
+        call(NativeBuiltins::get(NativeBuiltins::Id::deopt),
+             {paramCode(), paramClosure(), t.metadata, paramArgs(),
+              t.escapedEnv, t.reason, t.trigger});
+        builder.CreateUnreachable();
+        builder.SetInsertPoint(cur);
+    }
+    auto from = builder.GetInsertBlock();
+    t.metadata->addIncoming(metadata, from);
+    t.escapedEnv->addIncoming(escapedEnv, from);
+    t.reason->addIncoming(reason, from);
+    t.trigger->addIncoming(trigger, from);
+    builder.CreateBr(t.block);
 }
 
 llvm::Value* LowerFunctionLLVM::box(llvm::Value* v, PirType t, bool protect) {
@@ -1787,7 +1847,8 @@ void LowerFunctionLLVM::compileUnop(
 void LowerFunctionLLVM::writeBarrier(llvm::Value* x, llvm::Value* y,
                                      std::function<void()> no,
                                      std::function<void()> yes) {
-    auto sxpinfoX = builder.CreateLoad(sxpinfoPtr(x));
+    auto sxpinfoX =
+        tbaa::annotate(builder.CreateLoad(sxpinfoPtr(x)), tbaa::sxpinfo);
 
     auto markBitPos = c((unsigned long)(1ul << (TYPE_BITS + 19)));
     auto genBitPos = c((unsigned long)(1ul << (TYPE_BITS + 23)));
@@ -1805,7 +1866,8 @@ void LowerFunctionLLVM::writeBarrier(llvm::Value* x, llvm::Value* y,
     builder.CreateCondBr(markBitX, maybeNeedsBarrier, noBarrier);
 
     builder.SetInsertPoint(maybeNeedsBarrier);
-    auto sxpinfoY = builder.CreateLoad(sxpinfoPtr(y));
+    auto sxpinfoY =
+        tbaa::annotate(builder.CreateLoad(sxpinfoPtr(y)), tbaa::sxpinfo);
     auto markBitY =
         builder.CreateICmpNE(builder.CreateAnd(sxpinfoY, markBitPos), c(0, 64));
     builder.CreateCondBr(markBitY, maybeNeedsBarrier2, needsBarrier);
@@ -1961,7 +2023,8 @@ void LowerFunctionLLVM::envStubSet(llvm::Value* x, int i, llvm::Value* y,
 
 llvm::Value* LowerFunctionLLVM::isObj(llvm::Value* v) {
     checkIsSexp(v, "in IsObj");
-    auto sxpinfo = builder.CreateLoad(sxpinfoPtr(v));
+    auto sxpinfo =
+        tbaa::annotate(builder.CreateLoad(sxpinfoPtr(v)), tbaa::sxpinfo);
     return builder.CreateICmpNE(
         c(0, 64),
         builder.CreateAnd(sxpinfo, c((unsigned long)(1ul << (TYPE_BITS + 1)))));
@@ -1985,7 +2048,8 @@ llvm::Value* LowerFunctionLLVM::fastVeceltOkNative(llvm::Value* v) {
 
 llvm::Value* LowerFunctionLLVM::isAltrep(llvm::Value* v) {
     checkIsSexp(v, "in is altrep");
-    auto sxpinfo = builder.CreateLoad(sxpinfoPtr(v));
+    auto sxpinfo =
+        tbaa::annotate(builder.CreateLoad(sxpinfoPtr(v)), tbaa::sxpinfo);
     return builder.CreateICmpNE(
         c(0, 64),
         builder.CreateAnd(sxpinfo, c((unsigned long)(1ul << (TYPE_BITS + 2)))));
@@ -2055,6 +2119,123 @@ llvm::Value* LowerFunctionLLVM::createSelect2(
     return r;
 }
 
+// Matches a block ending in a branch on `x == k`, returns the comparison and
+// collects the instructions computing the condition from it
+static Eq* matchSwitchCase(BB* bb, std::vector<Instruction*>& condition) {
+    if (!bb->isBranch())
+        return nullptr;
+    auto br = Branch::Cast(bb->last());
+    if (!br)
+        return nullptr;
+    auto v = br->arg(0).val();
+    while (auto i = Instruction::Cast(v)) {
+        condition.push_back(i);
+        if (auto id = Identical::Cast(i)) {
+            if (id->arg(1).val() != True::instance())
+                return nullptr;
+            v = id->arg(0).val();
+        } else if (auto check = CheckTrueFalse::Cast(i)) {
+            v = check->val();
+        } else {
+            return Eq::Cast(i);
+        }
+    }
+    return nullptr;
+}
+
+// Case constants of integer switches are non-NA integers. For character
+// switches it is the CHARSXP of the name, restricted to ASCII such that
+// different names are different CHARSXPs.
+static SEXP switchCaseKey(Value* v, bool integer) {
+    auto k = Const::Cast(v);
+    if (!k)
+        return nullptr;
+    auto co = k->c();
+    if (integer) {
+        if (IS_SIMPLE_SCALAR(co, INTSXP) && INTEGER(co)[0] != NA_INTEGER)
+            return co;
+        return nullptr;
+    }
+    if (TYPEOF(co) == SYMSXP)
+        co = PRINTNAME(co);
+    else if (IS_SIMPLE_SCALAR(co, STRSXP))
+        co = STRING_ELT(co, 0);
+    else
+        return nullptr;
+    if (co == NA_STRING)
+        return nullptr;
+    for (auto s = CHAR(co); *s; ++s)
+        if ((unsigned char)*s >= 0x80)
+            return nullptr;
+    return co;
+}
+
+bool LowerFunctionLLVM::compileSwitchChain(const SwitchChain& chain) {
+    bool integer = Rep::Of(chain.value) == Rep::i32;
+    auto fallthrough = chain.cases.back().second->falseBranch();
+
+    llvm::BasicBlock* compare = nullptr;
+    llvm::SwitchInst* sw;
+    if (integer) {
+        sw = builder.CreateSwitch(load(chain.value, Rep::i32),
+                                  getBlock(fallthrough), chain.cases.size());
+    } else {
+        // Strings are looked up by their CHARSXP, anything else and names
+        // which are not found go through the original comparisons
+        auto lookup =
+            BasicBlock::Create(PirJitLLVM::getContext(), "switchLookup", fun);
+        compare =
+            BasicBlock::Create(PirJitLLVM::getContext(), "switchCompare", fun);
+        auto x = loadSxp(chain.value);
+        auto ok = builder.CreateAnd(isSimpleScalar(x, STRSXP),
+                                    builder.CreateNot(isAltrep(x)));
+        builder.CreateCondBr(ok, lookup, compare, branchMostlyTrue);
+        builder.SetInsertPoint(lookup);
+        auto data = builder.CreateBitCast(dataPtr(x), t::SEXP_ptr);
+        auto str = tbaa::annotate(builder.CreateLoad(data), tbaa::sexpData);
+        sw = builder.CreateSwitch(builder.CreatePtrToInt(str, t::i64), compare,
+                                  chain.cases.size());
+    }
+
+    std::vector<uint32_t> weights;
+    auto last = Branch::Cast(chain.cases.back().second->last());
+    weights.push_back(last->notTakenCount + 1);
+    bool observed = last->notTakenCount > 0;
+    for (auto& cs : chain.cases) {
+        auto key = cs.first;
+        llvm::ConstantInt* k;
+        if (integer) {
+            k = cast<ConstantInt>(c(INTEGER(key)[0]));
+        } else {
+            k = cast<ConstantInt>(c((unsigned long)key));
+            // Keeps the CHARSXP, and therefore its address, alive
+            target->addExtraPoolEntry(key);
+        }
+        // Only the first of duplicated cases is ever taken
+        if (sw->findCaseValue(k) != sw->case_default())
+            continue;
+        sw->addCase(k, getBlock(cs.second->trueBranch()));
+        auto br = Branch::Cast(cs.second->last());
+        weights.push_back(br->takenCount + 1);
+        observed = observed || br->takenCount > 0;
+    }
+    // NA does not match any case, but the comparisons might raise an error
+    if (integer && chain.value->type.maybeNAOrNaN()) {
+        sw->addCase(cast<ConstantInt>(c(NA_INTEGER)),
+                    getBlock(chain.cases.front().second->falseBranch()));
+        weights.push_back(1);
+    }
+    if (observed)
+        sw->setMetadata(LLVMContext::MD_prof,
+                        MDB.createBranchWeights(weights));
+
+    if (compare) {
+        builder.SetInsertPoint(compare);
+        return false;
+    }
+    return true;
+}
+
 void LowerFunctionLLVM::compile() {
 
     {
@@ -2209,6 +2390,10 @@ void LowerFunctionLLVM::compile() {
                     pop ? BasicBlock::Create(PirJitLLVM::getContext(), "", fun)
                         : nullptr};
 
+                // Nothing to restore if we never come back through setjmp
+                if (push->lightweight)
+                    return;
+
                 // Everything which is live at the Push context needs to be
                 // mutable, to be able to restore on restart
                 Visitor::run(code->entry, [&](Instruction* j) {
@@ -2234,6 +2419,102 @@ void LowerFunctionLLVM::compile() {
         });
     }
 
+    // Blocks only entered through a branch which was never observed to go
+    // there, and the jumps they lead into
+    std::unordered_set<BB*> rarelyEntered;
+    {
+        static constexpr unsigned MIN_OBSERVED = 8;
+        std::vector<BB*> todo;
+        auto rare = [&](BB* bb) {
+            if (bb->predecessors().size() == 1 && !rarelyEntered.count(bb)) {
+                rarelyEntered.insert(bb);
+                todo.push_back(bb);
+            }
+        };
+        Visitor::run(code->entry, [&](BB* bb) {
+            if (!bb->isBranch())
+                return;
+            auto br = Branch::Cast(bb->last());
+            if (!br)
+                return;
+            if (br->takenCount == 0 && br->notTakenCount >= MIN_OBSERVED)
+                rare(bb->trueBranch());
+            if (br->notTakenCount == 0 && br->takenCount >= MIN_OBSERVED)
+                rare(bb->falseBranch());
+        });
+        while (!todo.empty()) {
+            auto bb = todo.back();
+            todo.pop_back();
+            if (bb->isJmp())
+                rare(bb->next());
+        }
+    }
+
+    // Chains of comparisons against constants, emitted for the cases of
+    // switch(), are dispatched through a jump table. The blocks following the
+    // first one are skipped, they must not compute anything else.
+    std::unordered_map<BB*, SwitchChain> switchChains;
+    {
+        static constexpr size_t MIN_CASES = 3;
+        auto deopts = [](BB* bb) {
+            return bb->isDeopt() || (bb->isJmp() && bb->next()->isDeopt());
+        };
+        auto matchCase = [&](BB* bb, bool onlyCase, Value*& x, SEXP& key) {
+            std::vector<Instruction*> condition;
+            auto eq = matchSwitchCase(bb, condition);
+            if (!eq || deopts(bb->trueBranch()) || deopts(bb->falseBranch()))
+                return false;
+            if (onlyCase) {
+                if (bb->size() != condition.size() + 1)
+                    return false;
+                for (auto i : condition)
+                    if (i->bb() != bb || !i->hasSingleUse())
+                        return false;
+            }
+            for (size_t k = 0; k < 2; ++k) {
+                auto v = eq->arg(1 - k).val();
+                if (Const::Cast(v) || (x && v != x))
+                    continue;
+                auto r = Rep::Of(v);
+                if (r == Rep::i32)
+                    key = switchCaseKey(eq->arg(k).val(), true);
+                else if (r == Rep::SEXP)
+                    key = switchCaseKey(eq->arg(k).val(), false);
+                else
+                    continue;
+                if (key) {
+                    x = v;
+                    return true;
+                }
+            }
+            return false;
+        };
+        Visitor::run(code->entry, [&](BB* bb) {
+            Value* x = nullptr;
+            SEXP key;
+            if (!matchCase(bb, false, x, key))
+                return;
+            if (bb->hasSinglePred()) {
+                // Continues the chain of its predecessor
+                auto pred = *bb->predecessors().begin();
+                auto px = x;
+                SEXP pkey;
+                if (pred->isBranch() && pred->falseBranch() == bb &&
+                    matchCase(bb, true, px, pkey) &&
+                    matchCase(pred, false, px, pkey))
+                    return;
+            }
+            SwitchChain chain = {x, {{key, bb}}};
+            auto next = bb->falseBranch();
+            while (next->hasSinglePred() && matchCase(next, true, x, key)) {
+                chain.cases.push_back({key, next});
+                next = next->falseBranch();
+            }
+            if (chain.cases.size() >= MIN_CASES)
+                switchChains.emplace(bb, chain);
+        });
+    }
+
     std::unordered_map<BB*, int> blockInPushContext;
     blockInPushContext[code->entry] = 0;
 
@@ -2241,6 +2522,8 @@ void LowerFunctionLLVM::compile() {
         currentBB = bb;
 
         builder.SetInsertPoint(getBlock(bb));
+        if (bb->isDeopt() || rarelyEntered.count(bb))
+            coldBlocks.insert(getBlock(bb));
         inPushContext = blockInPushContext.at(bb);
 
         if (LLVMDebugInfo()) {
@@ -3372,6 +3655,13 @@ void LowerFunctionLLVM::compile() {
                     names.push_back(Pool::insert((b->names[i])));
                 auto namesConst = c(names);
                 auto namesStore = globalConst(namesConst);
+                // Mutable, filled in by the runtime on the first call
+                auto argmatchTy = llvm::ArrayType::get(
+                    t::i8, sizeof(BC::CallArgmatchCache));
+                auto argmatchStore = new llvm::GlobalVariable(
+                    getModule(), argmatchTy, false,
+                    llvm::GlobalValue::PrivateLinkage,
+                    llvm::ConstantAggregateZero::get(argmatchTy));
 
                 auto callId = ArglistOrder::NOT_REORDERED;
                 if (b->isReordered())
@@ -3389,6 +3679,8 @@ void LowerFunctionLLVM::compile() {
                                 loadSxp(b->env()),
                                 c(b->nCallArgs()),
                                 builder.CreateBitCast(namesStore, t::IntPtr),
+                                builder.CreateBitCast(argmatchStore,
+                                                      t::voidPtr),
                                 c(asmpt.toI()),
                             });
                     }));
@@ -3398,7 +3690,7 @@ void LowerFunctionLLVM::compile() {
             case Tag::StaticCall: {
                 auto calli = StaticCall::Cast(i);
                 calli->eachArg([](Value* v) { assert(!ExpandDots::Cast(v)); });
-                auto target = calli->tryDispatch();
+                auto dispatchTarget = calli->tryDispatch();
                 auto bestTarget = calli->tryOptimisticDispatch();
                 std::vector<Value*> args;
                 calli->eachCallArg([&](Value* v) { args.push_back(v); });
@@ -3408,7 +3700,7 @@ void LowerFunctionLLVM::compile() {
                 if (calli->isReordered())
                     callId = pushArgReordering(calli->getArgOrderOrig());
 
-                if (!target->owner()->hasOriginClosure()) {
+                if (!dispatchTarget->owner()->hasOriginClosure()) {
                     setVal(
                         i, withCallFrame(args, [&]() -> llvm::Value* {
                             return call(
@@ -3421,13 +3713,34 @@ void LowerFunctionLLVM::compile() {
                     break;
                 }
 
-                if (target == bestTarget) {
-                    auto callee = target->owner()->rirClosure();
+                if (dispatchTarget == cls && code == cls &&
+                    dispatchTarget == bestTarget) {
+                    // Direct self-recursion, we already know the target
+                    assert(asmpt.includes(Assumption::StaticallyArgmatched));
+                    auto callee = dispatchTarget->owner()->rirClosure();
+                    setVal(i, withCallFrame(args, [&]() {
+                               return call(NativeBuiltins::get(
+                                               NativeBuiltins::Id::nativeSelfCall),
+                                           {
+                                               c(callId),
+                                               paramCode(),
+                                               constant(callee, t::SEXP),
+                                               c(calli->srcIdx),
+                                               loadSxp(calli->env()),
+                                               c(args.size()),
+                                               c(asmpt.toI()),
+                                           });
+                           }));
+                    break;
+                }
+
+                if (dispatchTarget == bestTarget) {
+                    auto callee = dispatchTarget->owner()->rirClosure();
                     auto dt = DispatchTable::check(BODY(callee));
                     rir::Function* nativeTarget = nullptr;
                     for (size_t i = 0; i < dt->size(); i++) {
                         auto entry = dt->get(i);
-                        if (entry->context() == target->context() &&
+                        if (entry->context() == dispatchTarget->context() &&
                             entry->signature().numArguments >= args.size()) {
                             nativeTarget = entry;
                         }
@@ -3435,12 +3748,13 @@ void LowerFunctionLLVM::compile() {
                     if (nativeTarget) {
                         assert(
                             asmpt.includes(Assumption::StaticallyArgmatched));
-                        auto idx = Pool::makeSpace();
-                        NativeBuiltins::targetCaches.push_back(idx);
+                        auto idx = Pool::makeSpace(target);
+                        NativeBuiltins::targetCaches.insert(idx);
                         Pool::patch(idx, nativeTarget->container());
                         auto missAsmptStore =
                             Rf_allocVector(RAWSXP, sizeof(Context));
-                        auto missAsmptIdx = Pool::insert(missAsmptStore);
+                        auto missAsmptIdx =
+                            Pool::insertOwned(missAsmptStore, target);
                         new (DATAPTR(missAsmptStore))
                             Context(nativeTarget->context() - asmpt);
                         assert(asmpt.smaller(nativeTarget->context()));
@@ -3542,7 +3856,16 @@ void LowerFunctionLLVM::compile() {
                                      NativeBuiltins::Id::deoptChaosTrigger),
                                  {builder.getFalse()}));
                     weight = branchAlwaysTrue;
+                } else if (br->takenCount + br->notTakenCount > 0) {
+                    // Observed frequencies, smoothed such that neither side
+                    // is considered unreachable
+                    weight = MDB.createBranchWeights(br->takenCount + 1,
+                                                     br->notTakenCount + 1);
                 }
+                auto chain = switchChains.find(bb);
+                if (chain != switchChains.end() &&
+                    compileSwitchChain(chain->second))
+                    break;
                 builder.CreateCondBr(cond, getBlock(bb->trueBranch()),
                                      getBlock(bb->falseBranch()), weight);
                 break;
@@ -3582,15 +3905,15 @@ void LowerFunctionLLVM::compile() {
                     target->addExtraPoolEntry(store);
                 }
 
-                withCallFrame(args, [&]() {
-                    return call(NativeBuiltins::get(NativeBuiltins::Id::deopt),
-                                {paramCode(), paramClosure(),
-                                 convertToPointer(m, t::i8, true), paramArgs(),
-                                 c(deopt->escapedEnv, 1),
-                                 load(deopt->deoptReason()),
-                                 loadSxp(deopt->deoptTrigger())});
-                });
-                builder.CreateUnreachable();
+                incStack(args.size(), false);
+                std::vector<llvm::Value*> jitArgs;
+                for (auto& arg : args)
+                    jitArgs.push_back(load(arg, Rep::SEXP));
+                stack(jitArgs);
+                jumpToDeoptTrampoline(convertToPointer(m, t::i8, true),
+                                      c(deopt->escapedEnv, 1),
+                                      load(deopt->deoptReason()),
+                                      loadSxp(deopt->deoptTrigger()));
                 break;
             }
 
@@ -4657,8 +4980,8 @@ void LowerFunctionLLVM::compile() {
 
                     auto done =
                         BasicBlock::Create(PirJitLLVM::getContext(), "", fun);
-                    auto isNa = BasicBlock::Create(PirJitLLVM::getContext(),
-                                                   "asTestIsNa", fun);
+                    // Only leads to an error
+                    auto isNa = coldBlock();
 
                     if (r == Rep::f64) {
                         auto narg = load(arg, r);
@@ -4972,8 +5295,7 @@ void LowerFunctionLLVM::compile() {
                 auto res = phiBuilder(Rep::Of(i).toLlvm());
 
                 if (fastcase) {
-                    auto fallback =
-                        BasicBlock::Create(PirJitLLVM::getContext(), "", fun);
+                    auto fallback = coldBlock();
                     done =
                         BasicBlock::Create(PirJitLLVM::getContext(), "", fun);
 
@@ -5042,8 +5364,7 @@ void LowerFunctionLLVM::compile() {
                 auto res = phiBuilder(Rep::Of(i).toLlvm());
 
                 if (fastcase) {
-                    auto fallback =
-                        BasicBlock::Create(PirJitLLVM::getContext(), "", fun);
+                    auto fallback = coldBlock();
                     done =
                         BasicBlock::Create(PirJitLLVM::getContext(), "", fun);
 
@@ -5125,8 +5446,7 @@ void LowerFunctionLLVM::compile() {
                 auto res = phiBuilder(Rep::Of(i).toLlvm());
 
                 if (fastcase) {
-                    auto fallback =
-                        BasicBlock::Create(PirJitLLVM::getContext(), "", fun);
+                    auto fallback = coldBlock();
 
                     done =
                         BasicBlock::Create(PirJitLLVM::getContext(), "", fun);
@@ -5224,8 +5544,7 @@ void LowerFunctionLLVM::compile() {
                 auto res = phiBuilder(Rep::Of(i).toLlvm());
 
                 if (fastcase) {
-                    auto fallback =
-                        BasicBlock::Create(PirJitLLVM::getContext(), "", fun);
+                    auto fallback = coldBlock();
                     auto hit2 =
                         BasicBlock::Create(PirJitLLVM::getContext(), "", fun);
                     done =
@@ -5372,8 +5691,7 @@ void LowerFunctionLLVM::compile() {
                     fastcase = false;
 
                 if (fastcase) {
-                    auto fallback =
-                        BasicBlock::Create(PirJitLLVM::getContext(), "", fun);
+                    auto fallback = coldBlock();
                     done =
                         BasicBlock::Create(PirJitLLVM::getContext(), "", fun);
 
@@ -5493,8 +5811,7 @@ void LowerFunctionLLVM::compile() {
                     fastcase = false;
 
                 if (fastcase) {
-                    auto fallback =
-                        BasicBlock::Create(PirJitLLVM::getContext(), "", fun);
+                    auto fallback = coldBlock();
                     done =
                         BasicBlock::Create(PirJitLLVM::getContext(), "", fun);
 
@@ -5592,8 +5909,7 @@ void LowerFunctionLLVM::compile() {
                     fastcase = false;
 
                 if (fastcase) {
-                    auto fallback =
-                        BasicBlock::Create(PirJitLLVM::getContext(), "", fun);
+                    auto fallback = coldBlock();
                     done =
                         BasicBlock::Create(PirJitLLVM::getContext(), "", fun);
 
@@ -5687,8 +6003,7 @@ void LowerFunctionLLVM::compile() {
                     if (Rep::Of(st->val()) != Rep::SEXP) {
                         auto fastcase = BasicBlock::Create(
                             PirJitLLVM::getContext(), "", fun);
-                        auto fallback = BasicBlock::Create(
-                            PirJitLLVM::getContext(), "", fun);
+                        auto fallback = coldBlock();
 
                         auto expected =
                             Rep::Of(st->val()) == Rep::i32 ? INTSXP : REALSXP;
@@ -5701,7 +6016,9 @@ void LowerFunctionLLVM::compile() {
                         builder.SetInsertPoint(fastcase);
                         auto store =
                             vectorPositionPtr(cur, c(0), st->val()->type);
-                        builder.CreateStore(load(st->val()), store);
+                        tbaa::annotate(
+                            builder.CreateStore(load(st->val()), store),
+                            tbaa::vectorData(store->getType()));
                         builder.CreateBr(done);
 
                         builder.SetInsertPoint(fallback);
@@ -6235,6 +6552,14 @@ void LowerFunctionLLVM::compile() {
         decStack(sz + additionalStackSlots);
     }
 
+    // Keep the hot code together, cold blocks are laid out after it
+    std::vector<llvm::BasicBlock*> cold;
+    for (auto& bb : *fun)
+        if (coldBlocks.count(&bb))
+            cold.push_back(&bb);
+    for (auto bb : cold)
+        bb->moveAfter(&fun->back());
+
     if (RuntimeProfiler::enabled()) {
         std::unordered_set<rir::Code*> codes;
         std::unordered_map<size_t, const pir::TypeFeedback&> variableMapping;
@@ -46,6 +46,27 @@ class LowerFunctionLLVM {
     llvm::BasicBlock* entryBlock = nullptr;
     int inPushContext = 0;
     std::unordered_set<Value*> escapesInlineContext;
+    // Deopt and fallback blocks
+    std::unordered_set<llvm::BasicBlock*> coldBlocks;
+
+    // All deopt exits of the function share one call to the deopt builtin,
+    // the exits only push their frames
+    struct DeoptTrampoline {
+        llvm::BasicBlock* block = nullptr;
+        llvm::PHINode* metadata;
+        llvm::PHINode* escapedEnv;
+        llvm::PHINode* reason;
+        llvm::PHINode* trigger;
+    };
+    DeoptTrampoline deoptTrampoline;
+
+    // A chain of branches on `x == k` for constants k, each continuing with
+    // the next comparison if it fails, as emitted for the cases of switch()
+    struct SwitchChain {
+        Value* value;
+        // The key of the constant compared in each block, see switchCaseKey
+        std::vector<std::pair<SEXP, BB*>> cases;
+    };
 
     struct ContextData {
         llvm::AllocaInst* rcntxt;
@@ -58,6 +79,9 @@ class LowerFunctionLLVM {
     std::vector<ArglistOrder::CallArglistOrder> argReordering;
 
     std::unordered_map<Value*, std::unordered_map<SEXP, size_t>> bindingsCache;
+    // Pool slots of the constants which are not interned anyway, they are
+    // owned by the target code
+    std::unordered_map<SEXP, BC::PoolIdx> ownedConstants;
     llvm::Value* bindingsCacheBase = nullptr;
 
     llvm::MDNode* branchAlwaysTrue;
@@ -391,8 +415,13 @@ class LowerFunctionLLVM {
 
     llvm::Value* checkDoubleToInt(llvm::Value*, const PirType&);
 
+    // Calls emitted into cold blocks are marked as cold
     llvm::CallInst* call(const NativeBuiltin& builtin,
                          const std::vector<llvm::Value*>& args);
+    // A block for slow paths, which are rarely taken
+    llvm::BasicBlock* coldBlock();
+    void jumpToDeoptTrampoline(llvm::Value* metadata, llvm::Value* escapedEnv,
+                               llvm::Value* reason, llvm::Value* trigger);
     llvm::Value* callRBuiltin(SEXP builtin, const std::vector<Value*>& args,
                               int srcIdx, CCODE, llvm::Value* env);
 
@@ -418,6 +447,11 @@ class LowerFunctionLLVM {
                         const std::function<llvm::Value*()>& callee,
                         const std::function<SEXP(size_t)>& names);
 
+    // Dispatches the whole chain through an LLVM switch instead of the
+    // branch ending its first block. Returns false if only the lookup was
+    // emitted, the builder is then positioned at the fallback comparisons.
+    bool compileSwitchChain(const SwitchChain& chain);
+
     void compilePushContext(Instruction* i);
     void compilePopContext(Instruction* i);
 
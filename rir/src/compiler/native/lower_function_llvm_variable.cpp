@@ -55,6 +55,7 @@ llvm::Value* LowerFunctionLLVM::Variable::get(llvm::IRBuilder<>& builder) {
     switch (kind) {
     case ImmutableLocalRVariable:
     case MutableLocalRVariable:
+        return tbaa::annotate(builder.CreateLoad(slot), tbaa::nodeStack);
     case MutablePrimitive:
         return builder.CreateLoad(slot);
     case ImmutablePrimitive:
@@ -69,6 +70,10 @@ void LowerFunctionLLVM::Variable::update(llvm::IRBuilder<>& builder,
     initialized = true;
     switch (kind) {
     case MutableLocalRVariable:
+        assert(slot);
+        tbaa::annotate(builder.CreateStore(val, slot, volatile_),
+                       tbaa::nodeStack);
+        break;
     case MutablePrimitive:
         assert(slot);
         builder.CreateStore(val, slot, volatile_);
@@ -87,6 +92,10 @@ void LowerFunctionLLVM::Variable::set(llvm::IRBuilder<>& builder,
     switch (kind) {
     case ImmutableLocalRVariable:
     case MutableLocalRVariable:
+        assert(slot);
+        tbaa::annotate(builder.CreateStore(val, slot, volatile_),
+                       tbaa::nodeStack);
+        break;
     case MutablePrimitive:
         assert(slot);
         builder.CreateStore(val, slot, volatile_);
@@ -27,6 +27,8 @@ std::unique_ptr<llvm::orc::LLJIT> PirJitLLVM::JIT;
 
 size_t PirJitLLVM::nModules = 1;
 bool PirJitLLVM::initialized = false;
+std::unordered_map<size_t, llvm::orc::ResourceTrackerSP> PirJitLLVM::trackers;
+std::vector<size_t> PirJitLLVM::unreachable;
 
 bool LLVMDebugInfo() {
     return DebugOptions::DefaultDebugOptions.flags.contains(
@@ -316,17 +318,40 @@ void PirJitLLVM::finalize() {
         if (LLVMDebugInfo()) {
             DIB->finalize();
         }
+        sweep();
         // TODO: maybe later have TSM from the start and use locking
         //       to allow concurrent compilation?
         auto TSM = llvm::orc::ThreadSafeModule(std::move(M), TSC);
-        ExitOnErr(JIT->addIRModule(std::move(TSM)));
-        for (auto& fix : jitFixup)
+        auto tracker = JIT->getMainJITDylib().createResourceTracker();
+        ExitOnErr(JIT->addIRModule(tracker, std::move(TSM)));
+        trackers.emplace(nModules, tracker);
+
+        SEXP token = R_MakeExternalPtr((void*)nModules, R_NilValue, R_NilValue);
+        PROTECT(token);
+        R_RegisterCFinalizerEx(token, moduleUnreachable, FALSE);
+        for (auto& fix : jitFixup) {
             fix.second.first->lazyCodeHandle(fix.second.second.str());
+            fix.second.first->addExtraPoolEntry(token);
+        }
+        UNPROTECT(1);
         nModules++;
     }
     finalized = true;
 }
 
+void PirJitLLVM::moduleUnreachable(SEXP token) {
+    unreachable.push_back((size_t)R_ExternalPtrAddr(token));
+    R_ClearExternalPtr(token);
+}
+
+void PirJitLLVM::sweep() {
+    for (auto m : unreachable) {
+        ExitOnErr(trackers.at(m)->remove());
+        trackers.erase(m);
+    }
+    unreachable.clear();
+}
+
 void PirJitLLVM::compile(
     rir::Code* target, ClosureVersion* closure, Code* code,
     const PromMap& promMap, const NeedsRefcountAdjustment& refcount,
@@ -22,6 +22,7 @@
 #include <sstream>
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 namespace rir {
 
@@ -40,6 +41,9 @@ using PromMap = std::unordered_map<Code*, std::pair<unsigned, MkArg*>>;
 // to store code Modules (each corresponding to a PIR Module), the builtins
 // one just provides definitions of the statically compiled symbols and their
 // addresses for PIR builtins.
+// Every Module is added with its own ResourceTracker. The rir::Code objects
+// compiled from it share a token, once the token is collected the machine
+// code of the Module is freed (see sweep).
 class PirJitLLVM {
   public:
     static std::unique_ptr<llvm::orc::LLJIT> JIT;
@@ -54,6 +58,9 @@ class PirJitLLVM {
                  ClosureLog& log);
     void finalize();
 
+    // Number of Modules whose machine code was not freed yet
+    static size_t liveModules() { return trackers.size(); }
+
     using GetModule = std::function<llvm::Module&()>;
     using GetFunction = std::function<llvm::Function*(Code*)>;
     using GetBuiltin = std::function<llvm::Function*(const NativeBuiltin&)>;
@@ -89,6 +96,14 @@ class PirJitLLVM {
     static void initializeLLVM();
     static bool initialized;
 
+    static std::unordered_map<size_t, llvm::orc::ResourceTrackerSP> trackers;
+    // Modules whose code objects were all collected
+    static std::vector<size_t> unreachable;
+    static void moduleUnreachable(SEXP token);
+    // Frees the unreachable modules. Done when the next module is added,
+    // rather than in the finalizer, so we do not call into LLVM during a gc.
+    static void sweep();
+
     // Support for debugging pir in gdb
   public:
     static std::string makeDbgFileName(const std::string& base) {
@@ -1,6 +1,8 @@
 #include "types_llvm.h"
 #include "builtins.h"
 
+#include "llvm/IR/MDBuilder.h"
+
 namespace rir {
 namespace pir {
 
@@ -145,6 +147,29 @@ void initializeTypes(LLVMContext& context) {
     DECLARE(int_sexp, t::Int, t::SEXP);
     DECLARE(double_sexp, t::Double, t::SEXP);
 #undef DECLARE
+
+    MDBuilder MDB(context);
+    auto root = MDB.createTBAARoot("rir TBAA");
+    auto sexp = MDB.createTBAAScalarTypeNode("sexp", root);
+    auto header = MDB.createTBAAScalarTypeNode("sexp header", sexp);
+    auto cons = MDB.createTBAAScalarTypeNode("cons cell", sexp);
+    auto data = MDB.createTBAAScalarTypeNode("vector data", sexp);
+    auto stack = MDB.createTBAAScalarTypeNode("node stack", root);
+    auto access = [&](const char* name, MDNode* parent) {
+        auto type = MDB.createTBAAScalarTypeNode(name, parent);
+        return MDB.createTBAAStructTagNode(type, type, 0);
+    };
+    tbaa::sxpinfo = access("sxpinfo", header);
+    tbaa::attrib = access("attrib", header);
+    tbaa::vectorLength = access("vector length", header);
+    tbaa::car = access("car", cons);
+    tbaa::cdr = access("cdr", cons);
+    tbaa::tag = access("tag", cons);
+    tbaa::intData = access("int data", data);
+    tbaa::realData = access("real data", data);
+    tbaa::sexpData = access("sexp data", data);
+    tbaa::nodeStack = access("node stack cell", stack);
+    tbaa::nodeStackTop = access("node stack top", stack);
 }
 
 namespace t {
@@ -225,5 +250,30 @@ StructType* stackCell;
 PointerType* stackCellPtr;
 
 } // namespace t
+
+namespace tbaa {
+
+MDNode* sxpinfo;
+MDNode* attrib;
+MDNode* car;
+MDNode* cdr;
+MDNode* tag;
+MDNode* vectorLength;
+MDNode* intData;
+MDNode* realData;
+MDNode* sexpData;
+MDNode* nodeStack;
+MDNode* nodeStackTop;
+
+MDNode* vectorData(Type* elementPtr) {
+    if (elementPtr == t::IntPtr)
+        return intData;
+    if (elementPtr == t::DoublePtr)
+        return realData;
+    assert(elementPtr == t::SEXP_ptr);
+    return sexpData;
+}
+
+} // namespace tbaa
 } // namespace pir
 } // namespace rir
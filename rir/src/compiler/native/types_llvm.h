@@ -3,6 +3,7 @@
 
 #include "llvm/IR/DerivedTypes.h"
 #include "llvm/IR/LLVMContext.h"
+#include "llvm/IR/Metadata.h"
 
 namespace rir {
 namespace pir {
@@ -87,6 +88,38 @@ extern llvm::FunctionType* builtinFunction;
 extern llvm::Type* builtinFunctionPtr;
 
 } // namespace t
+
+/** Type based alias analysis tags for the memory accessed by native code.
+ * Header fields, cons cell fields and vector payloads of different element
+ * types never overlap in a live object, neither do they with the node stack.
+ * Accesses without a tag may alias anything.
+ */
+namespace tbaa {
+
+extern llvm::MDNode* sxpinfo;
+extern llvm::MDNode* attrib;
+extern llvm::MDNode* car;
+extern llvm::MDNode* cdr;
+extern llvm::MDNode* tag;
+extern llvm::MDNode* vectorLength;
+// Payloads of INTSXP and LGLSXP, REALSXP and vectors of SEXPs
+extern llvm::MDNode* intData;
+extern llvm::MDNode* realData;
+extern llvm::MDNode* sexpData;
+// The cells of R_BCNodeStack and R_BCNodeStackTop itself
+extern llvm::MDNode* nodeStack;
+extern llvm::MDNode* nodeStackTop;
+
+// The payload tag for a pointer to int, double or SEXP elements
+llvm::MDNode* vectorData(llvm::Type* elementPtr);
+
+template <typename Access>
+Access* annotate(Access* access, llvm::MDNode* tag) {
+    access->setMetadata(llvm::LLVMContext::MD_tbaa, tag);
+    return access;
+}
+
+} // namespace tbaa
 } // namespace pir
 } // namespace rir
 
@@ -181,6 +181,7 @@ bool Cleanup::apply(Compiler&, ClosureVersion* cls, Code* code, AbstractLog&,
                             auto b = bb->getBranch(false);
                             bb->deleteSuccessors();
                             bb->setSuccessors({b, a});
+                            std::swap(br->takenCount, br->notTakenCount);
                         }
                     }
                 } else if (auto env = MkEnv::Cast(i)) {
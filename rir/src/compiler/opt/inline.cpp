@@ -15,6 +15,7 @@
 #include "utils/Pool.h"
 
 #include <algorithm>
+#include <sstream>
 #include <unordered_map>
 
 namespace rir {
@@ -36,12 +37,56 @@ bool Inline::apply(Compiler& cmp, ClosureVersion* cls, Code* code,
         return cls->rirFunction()->flags.contains(rir::Function::NotInlineable);
     };
 
-    Visitor::run(code->entry, [&](BB* bb) {
-        // Dangerous iterater usage, works since we do only update it in
-        // one place.
-        for (auto it = bb->begin(); it != bb->end() && fuel; it++) {
-            if (!CallInstruction::CastCall(*it))
-                continue;
+    // Rank the call sites by how often they run per invocation of the
+    // function over the size of the inlinee, such that fuel and the module
+    // budget go to the hottest sites first. The taken count of the call
+    // feedback already includes the branch frequencies on the way to the call.
+    struct Candidate {
+        Instruction* call;
+        double priority;
+    };
+    // Calls which were already considered and are still there. Inlining
+    // exposes the calls of the inlinee, those are ranked in the next round.
+    std::unordered_set<Instruction*> considered;
+    auto rankCalls = [&]() {
+        std::vector<Candidate> candidates;
+        Visitor::run(code->entry, [&](Instruction* i) {
+            auto call = CallInstruction::CastCall(i);
+            if (!call || considered.count(i))
+                return;
+            ClosureVersion* target = nullptr;
+            if (auto c = Call::Cast(i)) {
+                if (auto mk = MkCls::Cast(c->cls()->followCastsAndForce()))
+                    if (auto trgCls = mk->tryGetCls())
+                        target = c->tryDispatch(trgCls);
+            } else if (auto c = StaticCall::Cast(i)) {
+                target = c->tryDispatch();
+            }
+            if (!target)
+                return;
+            double frequency =
+                call->taken == CallInstruction::UnknownTaken ? 1 : call->taken;
+            candidates.push_back(
+                {i, frequency / (1 + target->numNonDeoptInstrs())});
+        });
+        std::stable_sort(candidates.begin(), candidates.end(),
+                         [](const Candidate& a, const Candidate& b) {
+                             return a.priority > b.priority;
+                         });
+        return candidates;
+    };
+
+    bool exposed = true;
+    while (exposed && fuel) {
+        exposed = false;
+        for (auto& candidate : rankCalls()) {
+            if (!fuel) {
+                log.inlining("out of fuel");
+                break;
+            }
+            auto bb = candidate.call->bb();
+            auto it = bb->atPosition(candidate.call);
+            considered.insert(candidate.call);
 
             Closure* inlineeCls = nullptr;
             ClosureVersion* inlinee = nullptr;
@@ -168,6 +213,7 @@ bool Inline::apply(Compiler& cmp, ClosureVersion* cls, Code* code,
                 });
             };
 
+            auto taken = CallInstruction::CastCall(*it)->taken;
             size_t weight = inlinee->numNonDeoptInstrs();
             // The taken information of the call instruction tells us how
             // many times a call was executed relative to function
@@ -213,6 +259,16 @@ bool Inline::apply(Compiler& cmp, ClosureVersion* cls, Code* code,
                 (*it)->typeFeedback().type.unboxable())
                 weight *= 0.9;
 
+            auto report = [&](const char* decision) {
+                std::stringstream msg;
+                msg << decision << " " << inlinee->name() << " (size "
+                    << inlinee->numNonDeoptInstrs() << ", weight " << weight;
+                if (taken != CallInstruction::UnknownTaken)
+                    msg << ", taken " << taken;
+                msg << ")";
+                log.inlining(msg.str());
+            };
+
             // No recursive inlining
             if (inlinee->owner() == cls->owner() ||
                 (callerFrameState &&
@@ -226,6 +282,7 @@ bool Inline::apply(Compiler& cmp, ClosureVersion* cls, Code* code,
                         Parameter::INLINER_MAX_INLINEE_SIZE * 4)
                     inlineeCls->rirFunction()->flags.set(
                         rir::Function::NotInlineable);
+                report("too big to inline");
                 continue;
             } else {
                 updateAllowInline(inlinee);
@@ -233,13 +290,20 @@ bool Inline::apply(Compiler& cmp, ClosureVersion* cls, Code* code,
                 if (allowInline == SafeToInline::No) {
                     inlineeCls->rirFunction()->flags.set(
                         rir::Function::NotInlineable);
+                    report("unsafe to inline");
                     continue;
                 }
             }
 
             if (!inlineeCls->rirFunction()->flags.contains(
-                    rir::Function::ForceInline))
+                    rir::Function::ForceInline)) {
+                if (cmp.module->inlinedInstrs + inlinee->numNonDeoptInstrs() >
+                    Parameter::INLINER_MODULE_BUDGET) {
+                    report("module budget exhausted, not inlining");
+                    continue;
+                }
                 fuel--;
+            }
 
             cls->inlinees++;
 
@@ -378,8 +442,12 @@ bool Inline::apply(Compiler& cmp, ClosureVersion* cls, Code* code,
                 bb->overrideNext(split);
                 inlineeCls->rirFunction()->flags.set(
                     rir::Function::NotInlineable);
+                report("failed to inline");
             } else {
                 anyChange = true;
+                exposed = true;
+                cmp.module->inlinedInstrs += inlinee->numNonDeoptInstrs();
+                report("inlined");
                 Checkpoint* cpAtCall = nullptr;
                 {
                     AvailableCheckpoints cp(cls, code, log);
@@ -473,17 +541,11 @@ bool Inline::apply(Compiler& cmp, ClosureVersion* cls, Code* code,
                 theCall->replaceUsesWith(inlineeRes);
 
                 // Remove the call instruction
+                considered.erase(theCall);
                 split->remove(split->begin());
             }
-
-            bb = split;
-            it = split->begin();
-
-            // Can happen if split only contained the call instruction
-            if (it == split->end())
-                break;
         }
-    });
+    }
 
     return anyChange;
 }
@@ -501,6 +563,10 @@ size_t Parameter::INLINER_INITIAL_FUEL =
     getenv("PIR_INLINER_INITIAL_FUEL")
         ? atoi(getenv("PIR_INLINER_INITIAL_FUEL"))
         : 15;
+size_t Parameter::INLINER_MODULE_BUDGET =
+    getenv("PIR_INLINER_MODULE_BUDGET")
+        ? atoi(getenv("PIR_INLINER_MODULE_BUDGET"))
+        : 5000;
 size_t Parameter::INLINER_INLINE_UNLIKELY =
     getenv("PIR_INLINER_INLINE_UNLIKELY")
         ? atoi(getenv("PIR_INLINER_INLINE_UNLIKELY"))
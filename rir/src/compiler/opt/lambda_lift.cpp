@@ -0,0 +1,397 @@
+#include "../analysis/cfg.h"
+#include "../pir/pir_impl.h"
+#include "../util/safe_builtins_list.h"
+#include "../util/visitor.h"
+#include "R/Protect.h"
+#include "R/Symbols.h"
+#include "R/r.h"
+#include "bc/Compiler.h"
+#include "interpreter/instance.h"
+#include "pass_definitions.h"
+#include "runtime/DispatchTable.h"
+
+#include <unordered_map>
+#include <unordered_set>
+
+namespace rir {
+namespace pir {
+
+/*
+ * Functions which inspect or modify environments by name (or hand out the
+ * current one). If either the outer or the inner function mentions any of
+ * those, we cannot reason about the bindings syntactically.
+ */
+static bool isReflective(SEXP sym) {
+    static const std::unordered_set<SEXP> reflective = {
+        Rf_install("assign"),         Rf_install("delayedAssign"),
+        Rf_install("makeActiveBinding"), Rf_install("get"),
+        Rf_install("get0"),           Rf_install("mget"),
+        Rf_install("local"),          Rf_install("with"),
+        Rf_install("within"),         Rf_install("evalq"),
+        Rf_install("eval.parent"),    Rf_install("sys.frames"),
+        Rf_install("list2env"),       Rf_install("attach"),
+        Rf_install("do.call"),        Rf_install("match.fun"),
+        Rf_install("NextMethod"),     Rf_install("~"),
+        symbol::remove,               symbol::rm,
+        symbol::eval,
+    };
+    return reflective.count(sym) ||
+           !SafeBuiltinsList::forInlineByName(sym);
+}
+
+static SEXP assignTarget(SEXP lhs) {
+    while (TYPEOF(lhs) == LANGSXP && CDR(lhs) != R_NilValue)
+        lhs = CADR(lhs);
+    if (TYPEOF(lhs) == STRSXP && XLENGTH(lhs) == 1)
+        return Rf_installTrChar(STRING_ELT(lhs, 0));
+    return TYPEOF(lhs) == SYMSXP ? lhs : nullptr;
+}
+
+/*
+ * Collects an over-approximation of the symbols an AST might look up. With
+ * bindingsOnly, only the symbols it might bind are collected instead:
+ * assignment targets and loop variables. The bodies of nested function
+ * literals then only contribute their superassignment targets, since
+ * everything else they do happens in their own environment.
+ */
+static void collectSymbols(SEXP e, bool bindingsOnly, bool inNested,
+                           std::unordered_set<SEXP>& res, bool& reflective) {
+    switch (TYPEOF(e)) {
+    case SYMSXP:
+        if (!bindingsOnly && e != R_MissingArg)
+            res.insert(e);
+        break;
+    case LANGSXP: {
+        auto fun = CAR(e);
+        if (TYPEOF(fun) == SYMSXP && isReflective(fun))
+            reflective = true;
+        if (fun == symbol::SuperAssign ||
+            ((fun == symbol::Assign || fun == symbol::Assign2) && !inNested)) {
+            if (CDR(e) != R_NilValue)
+                if (auto t = assignTarget(CADR(e)))
+                    res.insert(t);
+        }
+        if (fun == symbol::For && !inNested && CDR(e) != R_NilValue &&
+            TYPEOF(CADR(e)) == SYMSXP)
+            res.insert(CADR(e));
+        bool nested = inNested || (bindingsOnly && fun == symbol::Function);
+        for (auto c = e; c != R_NilValue; c = CDR(c))
+            collectSymbols(CAR(c), bindingsOnly, nested, res, reflective);
+        break;
+    }
+    case LISTSXP:
+        for (auto c = e; c != R_NilValue; c = CDR(c))
+            collectSymbols(CAR(c), bindingsOnly, inNested, res, reflective);
+        break;
+    default: {}
+    }
+}
+
+bool LambdaLift::apply(Compiler&, ClosureVersion* cls, Code* code,
+                       AbstractLog&, size_t) const {
+    std::unordered_set<MkCls*> candidates;
+    Visitor::run(code->entry, [&](Instruction* i) {
+        auto mk = MkCls::Cast(i);
+        if (!mk || !mk->originalBody)
+            return;
+        // Only closures directly capturing the function environment are
+        // considered. Inlined callees have their own environments, for which
+        // we do not have the source at hand.
+        auto env = MkEnv::Cast(mk->lexicalEnv());
+        if (!env || env->stub || env->lexicalEnv() != Env::notClosed())
+            return;
+        candidates.insert(mk);
+    });
+    if (candidates.empty())
+        return false;
+
+    // Over-approximate the names which can ever be bound in the function
+    // environment, including by the baseline code after a deopt.
+    std::unordered_set<SEXP> bound;
+    bool reflective = false;
+    auto fun = cls->owner();
+    for (auto n : fun->formals().names())
+        bound.insert(n);
+    collectSymbols(fun->formals().original(), true, false, bound, reflective);
+    collectSymbols(src_pool_at(fun->rirFunction()->body()->src), true, false,
+                   bound, reflective);
+    if (reflective)
+        return false;
+
+    // Escape analysis: the closure may only be called, or stored into its
+    // own enclosing environment. Otherwise someone could ask for its
+    // environment and observe the lifting.
+    auto isCallee = [&](Instruction* i, MkCls* mk) {
+        auto call = CallInstruction::CastCall(i);
+        if (!call)
+            return false;
+        bool asArg = false;
+        call->eachCallArg([&](Value* v) {
+            if (v == mk)
+                asArg = true;
+        });
+        if (asArg)
+            return false;
+        if (auto c = Call::Cast(i))
+            return c->cls() == mk;
+        if (auto c = NamedCall::Cast(i))
+            return c->cls() == mk;
+        if (auto c = StaticCall::Cast(i))
+            return c->runtimeClosure() == mk;
+        return false;
+    };
+
+    Visitor::run(code->entry, [&](Instruction* i) {
+        if (candidates.empty())
+            return;
+
+        // The function environment must not leak to anyone who could add
+        // bindings we do not see, ie. only calls to the candidate itself are
+        // allowed.
+        if (i->hasEnv() && MkEnv::Cast(i->env()) &&
+            (i->leaksEnv() || i->changesEnv()) && !StVar::Cast(i)) {
+            auto leaked = MkEnv::Cast(i->env());
+            for (auto it = candidates.begin(); it != candidates.end();) {
+                if ((*it)->lexicalEnv() == leaked && !isCallee(i, *it))
+                    it = candidates.erase(it);
+                else
+                    it++;
+            }
+        }
+        if (auto mkarg = MkArg::Cast(i)) {
+            if (!mkarg->isEager() && !mkarg->noReflection &&
+                !mkarg->prom()->trivial()) {
+                for (auto it = candidates.begin(); it != candidates.end();) {
+                    if ((*it)->lexicalEnv() == mkarg->promEnv())
+                        it = candidates.erase(it);
+                    else
+                        it++;
+                }
+            }
+        }
+
+        i->eachArg([&](Value* v) {
+            auto mk = MkCls::Cast(v);
+            if (!mk || !candidates.count(mk))
+                return;
+            if (isCallee(i, mk) || FrameState::Cast(i))
+                return;
+            if (auto st = StVar::Cast(i))
+                if (st->val() == mk && st->env() == mk->lexicalEnv())
+                    return;
+            candidates.erase(mk);
+        });
+    });
+
+    // Superassignments from any local closure could change the captured
+    // variables behind the back of a lifted closure.
+    std::unordered_set<SEXP> outerSymbols;
+    collectSymbols(src_pool_at(fun->rirFunction()->body()->src), false, false,
+                   outerSymbols, reflective);
+    bool superAssigns = outerSymbols.count(symbol::SuperAssign);
+
+    bool anyChange = false;
+    std::unordered_map<MkCls*, std::vector<SEXP>> lift;
+    for (auto mk : candidates) {
+        // Symbols the inner function might look up. Its own formals are always
+        // bound in its own environment and shadow everything else.
+        std::unordered_set<SEXP> free;
+        reflective = false;
+        collectSymbols(mk->formals, false, false, free, reflective);
+        collectSymbols(src_pool_at(mk->originalBody->baseline()->body()->src),
+                       false, false, free, reflective);
+        if (reflective)
+            continue;
+        bool dots = false;
+        for (auto f = mk->formals; f != R_NilValue; f = CDR(f)) {
+            free.erase(TAG(f));
+            dots = dots || TAG(f) == symbol::Ellipsis;
+        }
+
+        std::vector<SEXP> captured;
+        for (auto s : free)
+            if (bound.count(s))
+                captured.push_back(s);
+
+        if (captured.empty()) {
+            // Nothing the closure looks up can be found in the function
+            // environment, so it is equivalent to close over its parent.
+            // This frees the environment if the closure was the last one
+            // needing it.
+            auto env = MkEnv::Cast(mk->lexicalEnv());
+            mk->env(env->lexicalEnv());
+            anyChange = true;
+            continue;
+        }
+
+        // Otherwise the captured variables are passed as extra arguments.
+        // Their values are read at the call, thus nothing may change them
+        // while the closure runs, and no closure created inside may outlive
+        // the call.
+        if (superAssigns || dots || free.count(symbol::SuperAssign) ||
+            free.count(symbol::Function))
+            continue;
+        lift[mk] = captured;
+    }
+    if (lift.empty())
+        return anyChange;
+
+    // Every captured variable has to be bound in the function environment
+    // when the closure is called, else the lookup would continue in the
+    // parent. Bindings are never removed, so it suffices that it is bound
+    // initially or by a store dominating the call. The loads we insert at the
+    // calls can have any of the stored types.
+    auto argType = PirType(RType::prom) | PirType::val();
+    DominanceGraph dom(code);
+    std::unordered_map<SEXP, std::vector<StVar*>> stores;
+    Visitor::run(code->entry, [&](Instruction* i) {
+        if (auto st = StVar::Cast(i))
+            stores[st->varName].push_back(st);
+    });
+    auto storedType = [&](MkEnv* env, SEXP var) {
+        auto type = PirType::bottom();
+        env->eachLocalVar([&](SEXP name, Value* val, bool) {
+            if (name == var)
+                type = type | val->type;
+        });
+        for (auto st : stores[var])
+            if (st->env() == env)
+                type = type | st->val()->type;
+        return type;
+    };
+    auto isBound = [&](MkEnv* env, SEXP var, Instruction* call) {
+        bool bound = false;
+        env->eachLocalVar([&](SEXP name, Value*, bool) {
+            if (name == var)
+                bound = true;
+        });
+        for (auto st : stores[var])
+            if (st->env() == env && dom.dominates(st, call))
+                bound = true;
+        return bound;
+    };
+    auto calledClosure = [](Instruction* i) -> Value* {
+        if (auto c = Call::Cast(i))
+            return c->cls();
+        if (auto c = NamedCall::Cast(i))
+            return c->cls();
+        if (auto c = StaticCall::Cast(i))
+            return c->runtimeClosure();
+        return nullptr;
+    };
+
+    for (auto it = lift.begin(); it != lift.end();) {
+        auto mk = it->first;
+        auto env = MkEnv::Cast(mk->lexicalEnv());
+        bool ok = true;
+        for (auto var : it->second) {
+            auto type = storedType(env, var);
+            if (type.maybeMissing() || !type.isA(argType))
+                ok = false;
+        }
+        auto nformals = (size_t)Rf_length(mk->formals);
+        size_t calls = 0;
+        Visitor::run(code->entry, [&](Instruction* i) {
+            if (!ok || calledClosure(i) != mk)
+                return;
+            calls++;
+            auto call = CallInstruction::CastCall(i);
+            if (call->nCallArgs() > nformals)
+                ok = false;
+            call->eachNamedCallArg([&](SEXP name, Value* v) {
+                if (ExpandDots::Cast(v) || DotsList::Cast(v))
+                    ok = false;
+                // Otherwise the extra arguments could change how partial
+                // names are matched
+                if (name != R_NilValue) {
+                    bool exact = false;
+                    for (auto f = mk->formals; f != R_NilValue; f = CDR(f))
+                        exact = exact || TAG(f) == name;
+                    ok = ok && exact;
+                }
+            });
+            for (auto var : it->second)
+                ok = ok && isBound(env, var, i);
+        });
+        // Once lifted, the original closure is only left for the deopt
+        // states, or it was never called
+        if (ok && calls)
+            it++;
+        else
+            it = lift.erase(it);
+    }
+
+    for (auto& l : lift) {
+        auto mk = l.first;
+        auto& captured = l.second;
+        auto env = MkEnv::Cast(mk->lexicalEnv());
+
+        // The lifted function has the captured variables as additional
+        // formals and is closed over the parent of the function environment
+        Protect p;
+        SEXP formals = R_NilValue;
+        for (auto c = captured.rbegin(); c != captured.rend(); ++c) {
+            formals = p(CONS(R_MissingArg, formals));
+            SET_TAG(formals, *c);
+        }
+        std::vector<SEXP> original;
+        for (auto f = mk->formals; f != R_NilValue; f = CDR(f))
+            original.push_back(f);
+        for (auto f = original.rbegin(); f != original.rend(); ++f) {
+            formals = p(CONS(CAR(*f), formals));
+            SET_TAG(formals, TAG(*f));
+        }
+        auto body = src_pool_at(mk->originalBody->baseline()->body()->src);
+        auto dt = p(rir::Compiler::compileFunction(body, formals));
+        // Keep them alive as long as the function which uses them
+        auto owner = fun->rirFunction()->body();
+        owner->addExtraPoolEntry(formals);
+        owner->addExtraPoolEntry(dt);
+
+        auto lifted = new MkCls(nullptr, formals, mk->srcRef,
+                                DispatchTable::unpack(dt), env->lexicalEnv());
+        auto pos = mk->bb()->atPosition(mk);
+        mk->bb()->insert(pos + 1, lifted);
+
+        auto nformals = (size_t)Rf_length(mk->formals);
+        Visitor::run(code->entry, [&](BB* bb) {
+            for (auto ip = bb->begin(); ip != bb->end(); ++ip) {
+                auto i = *ip;
+                if (calledClosure(i) != mk)
+                    continue;
+                auto call = CallInstruction::CastCall(i);
+                std::vector<Value*> args;
+                std::vector<SEXP> names;
+                call->eachNamedCallArg([&](SEXP name, Value* v) {
+                    args.push_back(v);
+                    names.push_back(name);
+                });
+                // Positional arguments must not end up in the added formals
+                auto named = NamedCall::Cast(i);
+                while (!named && args.size() < nformals)
+                    args.push_back(MissingArg::instance());
+                for (auto var : captured) {
+                    auto ld = new LdVar(var, env);
+                    ld->type = storedType(env, var);
+                    ip = bb->insert(ip, ld) + 1;
+                    args.push_back(ld);
+                    names.push_back(var);
+                }
+                Instruction* nc;
+                if (named)
+                    nc = new NamedCall(i->env(), lifted, args, names,
+                                       call->frameStateOrTs(), i->srcIdx);
+                else
+                    nc = new Call(i->env(), lifted, args,
+                                  call->frameStateOrTs(), i->srcIdx);
+                i->replaceUsesAndSwapWith(nc, ip);
+            }
+        });
+        anyChange = true;
+    }
+
+    return anyChange;
+}
+
+} // namespace pir
+} // namespace rir
@@ -164,6 +164,26 @@ PASS(HoistInstruction, false, false)
 
 PASS(TypefeedbackCleanup, true, false)
 
+/*
+ * Escape analysis for local closures. A `MkCls` which is only ever called (or
+ * stored into its defining environment), and whose body cannot find any of
+ * the names bound in the defining environment, is re-closed over the parent
+ * of that environment. If it does look up some of those names, they are
+ * passed as additional arguments to a lifted copy of the closure, which is
+ * closed over the parent instead. Calls are then turned into `StaticCall`s by
+ * MatchCallArgs as usual, and the environment can be elided if the closure
+ * was the only thing pinning it.
+ */
+PASS(LambdaLift, false, false)
+
+/*
+ * Turns self-recursive StaticCalls in tail position into a back-edge to the
+ * function entry. Arguments become phis in the old entry block. Only done if
+ * no environment is materialized, since parent.frame and friends would
+ * observe the missing frames.
+ */
+PASS(TailCallElimination, false, false)
+
 class PhaseMarker : public Pass {
   public:
     explicit PhaseMarker(const std::string& name) : Pass(name) {}
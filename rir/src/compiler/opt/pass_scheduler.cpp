@@ -62,6 +62,7 @@ PassScheduler::PassScheduler(unsigned optLevel, bool isFinal) {
         add<OptimizeAssumptions>();
         add<Cleanup>();
 
+        add<LambdaLift>();
         add<ElideEnv>();
         add<DelayEnv>();
         add<DelayInstr>();
@@ -115,6 +116,7 @@ PassScheduler::PassScheduler(unsigned optLevel, bool isFinal) {
         addDefaultPostPhaseOpt();
 
         nextPhase("Intermediate 2", optLevel > 2 ? 60 : 0);
+        add<TailCallElimination>();
         addDefaultOpt();
         nextPhase("Intermediate 2 post");
         addDefaultPostPhaseOpt();
@@ -0,0 +1,100 @@
+#include "../analysis/query.h"
+#include "../pir/pir_impl.h"
+#include "../util/bb_transform.h"
+#include "../util/visitor.h"
+#include "R/r.h"
+#include "pass_definitions.h"
+
+#include <unordered_map>
+#include <vector>
+
+namespace rir {
+namespace pir {
+
+bool TailCallElimination::apply(Compiler&, ClosureVersion* cls, Code* code,
+                                AbstractLog&, size_t) const {
+    if (cls->owner()->formals().hasDots())
+        return false;
+    // With a materialized environment, parent.frame and friends would see
+    // the difference between a loop and a chain of calls.
+    if (!Query::noEnvSpec(code))
+        return false;
+
+    std::unordered_map<size_t, LdArg*> args;
+    bool duplicateArgs = false;
+    Visitor::run(code->entry, [&](Instruction* i) {
+        if (auto ld = LdArg::Cast(i)) {
+            if (args.count(ld->pos))
+                duplicateArgs = true;
+            args[ld->pos] = ld;
+        }
+    });
+    // GVN takes care of those, wait for it.
+    if (duplicateArgs)
+        return false;
+
+    std::vector<StaticCall*> tailCalls;
+    Visitor::run(code->entry, [&](BB* bb) {
+        if (bb->size() < 2)
+            return;
+        auto ret = Return::Cast(bb->last());
+        if (!ret)
+            return;
+        auto call = StaticCall::Cast(*(bb->end() - 2));
+        if (!call || ret->arg(0).val() != call)
+            return;
+        if (call->tryDispatch() != cls || call->isReordered() ||
+            call->nCallArgs() != cls->nargs())
+            return;
+        bool ok = true;
+        call->eachCallArg([&](Value* v) {
+            if (DotsList::Cast(v) || ExpandDots::Cast(v))
+                ok = false;
+        });
+        for (auto a : args) {
+            if (a.first >= call->nCallArgs() ||
+                !call->callArg(a.first).val()->type.isA(a.second->type))
+                ok = false;
+        }
+        if (ok)
+            tailCalls.push_back(call);
+    });
+    if (tailCalls.empty())
+        return false;
+
+    // Hoist the argument loads into a fresh entry block, the old entry becomes
+    // the loop header.
+    auto header = code->entry;
+    auto start = new BB(code, code->nextBBId++);
+    std::unordered_map<size_t, Phi*> phis;
+    for (auto a : args) {
+        auto ld = a.second;
+        auto phi = new Phi(ld->type);
+        ld->replaceUsesWith(phi);
+        auto bb = ld->bb();
+        bb->moveToEnd(bb->atPosition(ld), start);
+        phi->addInput(start, ld);
+        phis[a.first] = phi;
+    }
+    start->setNext(header);
+    code->entry = start;
+    for (auto p : phis)
+        header->insert(header->begin(), p.second);
+
+    for (auto call : tailCalls) {
+        auto bb = call->bb();
+        for (auto p : phis)
+            p.second->addInput(bb, call->callArg(p.first).val());
+        bb->remove(bb->end() - 1);
+        bb->remove(bb->end() - 1);
+        bb->setNext(header);
+    }
+    for (auto p : phis)
+        p.second->updateTypeAndEffects();
+
+    BBTransform::renumber(code);
+    return true;
+}
+
+} // namespace pir
+} // namespace rir
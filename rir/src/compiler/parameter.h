@@ -16,13 +16,20 @@ struct Parameter {
     static const unsigned PIR_WARMUP;
     static const unsigned PIR_OPT_TIME;
     static const unsigned PIR_REOPT_TIME;
+    static const bool PIR_ADAPTIVE_WARMUP;
+    static const unsigned PIR_OPT_BENEFIT;
+    static const unsigned PIR_COMPILE_COST;
+    static unsigned PIR_COMPILE_BUDGET;
+    static const unsigned PIR_COMPILE_WINDOW;
     static const unsigned DEOPT_ABANDON;
+    static const unsigned FEEDBACK_FREEZE;
 
     static size_t PROMISE_INLINER_MAX_SIZE;
 
     static size_t INLINER_MAX_SIZE;
     static size_t INLINER_MAX_INLINEE_SIZE;
     static size_t INLINER_INITIAL_FUEL;
+    static size_t INLINER_MODULE_BUDGET;
     static size_t INLINER_INLINE_UNLIKELY;
 
     static size_t RECOMPILE_THRESHOLD;
@@ -1193,6 +1193,9 @@ class Branch
                                  HasEnvSlot::No, Controlflow::Branch> {
   public:
     bool deoptTrigger = false;
+    // How often the test was observed TRUE and FALSE, zero if unknown
+    unsigned takenCount = 0;
+    unsigned notTakenCount = 0;
 
     explicit Branch(Value* test)
         : FixedLenInstruction(PirType::voyd(), {{PirType::test()}}, {{test}}) {}
@@ -2527,6 +2530,11 @@ class VLIE(PushContext, Effects(Effect::ChangesContexts) | Effect::LeaksArg |
     ArglistOrder::CallArglistOrder argOrderOrig;
 
   public:
+    // Nothing can ever longjmp to this context, ie. the inlinee never gets an
+    // environment which could be the target of a return or restart. The
+    // backend then only links the RCNTXT, without setjmp and restart support.
+    bool lightweight = false;
+
     PushContext(Value* ast, Value* op, CallInstruction* call, Value* sysparent)
         : VarLenInstructionWithEnvSlot(NativeType::context, sysparent) {
         call->eachCallArg([&](Value* v) { pushArg(v, PirType::any()); });
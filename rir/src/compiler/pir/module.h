@@ -41,6 +41,9 @@ class Module {
     Const* c(int s);
     Const* c(double s);
 
+    // Instructions the inliner copied into this module so far
+    size_t inlinedInstrs = 0;
+
     ~Module();
   private:
     typedef std::pair<Function*, Env*> Idx;
@@ -371,6 +371,7 @@ bool Rir2Pir::compileBC(const BC& bc, Opcode* pos, Opcode* nextPos,
 
     case Opcode::record_test_: {
         auto feedback = bc.immediate.testFeedback;
+        testFeedback[at(0)] = feedback;
         if (feedback.seen == ObservedTest::OnlyTrue ||
             feedback.seen == ObservedTest::OnlyFalse) {
             if (auto i = Instruction::Cast(at(0))) {
@@ -1300,6 +1301,7 @@ bool Rir2Pir::compileBC(const BC& bc, Opcode* pos, Opcode* nextPos,
     // Opcodes handled elsewhere
     case Opcode::brtrue_:
     case Opcode::brfalse_:
+    case Opcode::asbool_brtrue_:
     case Opcode::br_:
     case Opcode::close_:
     case Opcode::ret_:
@@ -1450,8 +1452,14 @@ Value* Rir2Pir::tryTranslate(rir::Code* srcCode, Builder& insert, Opcode* start,
 
             // Conditional jump
             assert(bc.isCondJmp());
+            if (bc.bc == Opcode::asbool_brtrue_) {
+                // Re-executing the superinstruction after a deopt at pos is
+                // fine, the condition is already TRUE or FALSE then.
+                auto cond = cur.stack.pop();
+                cur.stack.push(insert(new CheckTrueFalse(cond)));
+            }
             auto branchCondition = cur.stack.top();
-            auto branchReason = bc.bc == Opcode::brtrue_
+            auto branchReason = bc.bc != Opcode::brfalse_
                                     ? (Value*)True::instance()
                                     : (Value*)False::instance();
             auto asBool = insert(
@@ -1522,7 +1530,22 @@ Value* Rir2Pir::tryTranslate(rir::Code* srcCode, Builder& insert, Opcode* start,
             }
 
             cur.stack.pop();
-            insert(new Branch(asBool));
+            auto br = new Branch(asBool);
+            // The condition of an if is recorded before asbool_, it only
+            // weighs the branch
+            Value* recorded = branchCondition;
+            if (auto check = CheckTrueFalse::Cast(branchCondition))
+                if (!testFeedback.count(branchCondition))
+                    recorded = check->arg(0).val();
+            auto test = testFeedback.find(recorded);
+            if (test != testFeedback.end()) {
+                bool onTrue = branchReason == True::instance();
+                br->takenCount = onTrue ? test->second.trueCount
+                                        : test->second.falseCount;
+                br->notTakenCount = onTrue ? test->second.falseCount
+                                           : test->second.trueCount;
+            }
+            insert(br);
 
             BB* branch = insert.createBB();
             BB* fall = insert.createBB();
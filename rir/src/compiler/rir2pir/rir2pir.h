@@ -73,6 +73,9 @@ class Rir2Pir {
     };
     std::unordered_map<MkCls*, DelayedCompilation> delayedCompilation;
 
+    // Outcomes recorded by record_test_, by the tested value
+    std::unordered_map<Value*, ObservedTest> testFeedback;
+
     bool compileBC(const BC& bc, Opcode* pos, Opcode* nextPos,
                    rir::Code* srcCode, RirStack&, Builder&,
                    CallTargetCheckpoints&);
@@ -0,0 +1,158 @@
+#include "PassBenchmark.h"
+#include "../opt/pass.h"
+#include "../opt/pass_scheduler.h"
+#include "../pir/pir_impl.h"
+#include "R/Protect.h"
+#include "compiler/compiler.h"
+#include "runtime/DispatchTable.h"
+
+#include <chrono>
+#include <functional>
+
+namespace rir {
+
+using namespace pir;
+
+typedef std::chrono::high_resolution_clock Clock;
+
+static double msSince(const Clock::time_point& start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start)
+        .count();
+}
+
+static long moduleSize(Module* m) {
+    long s = 0;
+    m->eachPirClosureVersion([&](ClosureVersion* v) { s += v->numInstrs(); });
+    return s;
+}
+
+typedef std::function<void(Compiler&, Log&, Module*)> Optimize;
+
+// Translates the closure into a fresh module, which is then handed to
+// optimize. Returns false if Rir2Pir fails.
+static bool translate(SEXP f, double& time, const Optimize& optimize) {
+    auto table = DispatchTable::unpack(BODY(f));
+    auto assumptions = table->best()->context() | Compiler::minimalContext;
+
+    Module m;
+    DebugOptions options;
+    Log logger(options);
+    Compiler cmp(&m, logger);
+    bool success = false;
+    auto start = Clock::now();
+    cmp.compileClosure(
+        f, "passBenchmark", assumptions, true,
+        [&](ClosureVersion*) {
+            time = msSince(start);
+            success = true;
+            optimize(cmp, logger, &m);
+        },
+        []() {}, {});
+    return success;
+}
+
+PassBenchmark::Result& PassBenchmark::result(const std::string& pass) {
+    for (auto& r : results)
+        if (r.pass == pass)
+            return r;
+    results.emplace_back();
+    results.back().pass = pass;
+    return results.back();
+}
+
+void PassBenchmark::run(SEXP f) {
+    if (TYPEOF(f) != CLOSXP || !DispatchTable::check(BODY(f)))
+        return;
+
+    // The whole pipeline, like Compiler::optimizeModule does it
+    auto& translation = result("Rir2Pir");
+    double time;
+    bool translated = translate(f, time, [&](Compiler& cmp, Log&, Module* m) {
+        auto size = moduleSize(m);
+        translation.pipelineTime += time;
+        translation.pipelineRuns++;
+        translation.pipelineDelta += size;
+        translation.isolatedTime += time;
+        translation.isolatedRuns++;
+        translation.isolatedDelta += size;
+
+        Clock::time_point start;
+        long before = 0;
+        cmp.beforePass = [&](const Pass* pass, ClosureVersion* v) {
+            before = v->numInstrs();
+            start = Clock::now();
+        };
+        cmp.afterPass = [&](const Pass* pass, ClosureVersion* v) {
+            auto elapsed = msSince(start);
+            if (pass->isPhaseMarker())
+                return;
+            auto& r = result(pass->getName());
+            r.pipelineTime += elapsed;
+            r.pipelineRuns++;
+            r.pipelineDelta += (long)v->numInstrs() - before;
+        };
+        cmp.optimizeModule();
+    });
+    if (!translated)
+        return;
+    closures++;
+
+    // Every pass on its own, applied once to a fresh translation
+    std::vector<const Pass*> passes;
+    PassScheduler::instance().run([&](const Pass* pass, size_t) {
+        if (!pass->isPhaseMarker())
+            passes.push_back(pass);
+        return false;
+    });
+    for (auto pass : passes) {
+        auto& r = result(pass->getName());
+        if (r.isolatedRuns >= closures)
+            continue;
+        translate(f, time, [&](Compiler& cmp, Log& logger, Module* m) {
+            auto before = moduleSize(m);
+            auto start = Clock::now();
+            m->eachPirClosureVersion([&](ClosureVersion* v) {
+                pass->apply(cmp, v, logger.get(v), 0);
+            });
+            r.isolatedTime += msSince(start);
+            r.isolatedRuns++;
+            r.isolatedDelta += moduleSize(m) - before;
+        });
+    }
+}
+
+SEXP PassBenchmark::toList() const {
+    auto n = results.size();
+    const char* names[] = {"pass",         "pipelineTime", "pipelineRuns",
+                           "pipelineDelta", "isolatedTime", "isolatedRuns",
+                           "isolatedDelta"};
+    constexpr size_t columns = sizeof(names) / sizeof(names[0]);
+
+    Protect p;
+    SEXP res = p(Rf_allocVector(VECSXP, columns));
+    SEXP resNames = p(Rf_allocVector(STRSXP, columns));
+    SEXP pass = p(Rf_allocVector(STRSXP, n));
+    for (size_t i = 0; i < n; ++i)
+        SET_STRING_ELT(pass, i, Rf_mkChar(results[i].pass.c_str()));
+    SET_VECTOR_ELT(res, 0, pass);
+
+    std::function<double(const Result&)> values[] = {
+        [](const Result& r) { return r.pipelineTime; },
+        [](const Result& r) { return (double)r.pipelineRuns; },
+        [](const Result& r) { return (double)r.pipelineDelta; },
+        [](const Result& r) { return r.isolatedTime; },
+        [](const Result& r) { return (double)r.isolatedRuns; },
+        [](const Result& r) { return (double)r.isolatedDelta; }};
+    for (size_t c = 1; c < columns; ++c) {
+        SEXP column = Rf_allocVector(REALSXP, n);
+        SET_VECTOR_ELT(res, c, column);
+        for (size_t i = 0; i < n; ++i)
+            REAL(column)[i] = values[c - 1](results[i]);
+    }
+    for (size_t c = 0; c < columns; ++c)
+        SET_STRING_ELT(resNames, c, Rf_mkChar(names[c]));
+    Rf_setAttrib(res, R_NamesSymbol, resNames);
+    return res;
+}
+
+} // namespace rir
@@ -0,0 +1,41 @@
+#pragma once
+
+#include "R/r_incl.h"
+
+#include <string>
+#include <vector>
+
+namespace rir {
+
+/*
+ * Measures the cost of the PIR passes on a corpus of RIR closures. Every
+ * closure is translated by Rir2Pir and then optimized by the whole pass
+ * pipeline, and, separately for each pass, a fresh translation is optimized
+ * by that pass alone.
+ */
+struct PassBenchmark {
+    struct Result {
+        std::string pass;
+        // Time in ms, number of applications and change in the number of
+        // instructions, in the pipeline and in isolation
+        double pipelineTime = 0;
+        size_t pipelineRuns = 0;
+        long pipelineDelta = 0;
+        double isolatedTime = 0;
+        size_t isolatedRuns = 0;
+        long isolatedDelta = 0;
+    };
+
+    // The translation by Rir2Pir comes first
+    std::vector<Result> results;
+    size_t closures = 0;
+
+    void run(SEXP closure);
+    // A named list of columns, with one row per result
+    SEXP toList() const;
+
+  private:
+    Result& result(const std::string& pass);
+};
+
+} // namespace rir
@@ -1,4 +1,5 @@
 #include "PirCheck.h"
+#include "../analysis/loop_detection.h"
 #include "../analysis/query.h"
 #include "../analysis/verifier.h"
 #include "../pir/pir_impl.h"
@@ -243,6 +244,111 @@ static bool testAnAddIsNotNAOrNaN(ClosureVersion* f) {
     return success;
 }
 
+// Checks the predicate on every instruction inside of a loop. Deopt branches
+// leave the loop, so they are not part of it.
+static bool checkLoops(ClosureVersion* f,
+                       const LoopDetection::InstrActionPredicate& pred) {
+    LoopDetection loops(f);
+    for (auto& loop : loops)
+        if (!loop.check(pred))
+            return false;
+    return true;
+}
+
+// Does the instruction need its argument v as a SEXP, even though v has an
+// unboxed representation in native code?
+static bool boxes(Instruction* i, Value* v) {
+    if (Const::Cast(v) || !v->type.unboxable())
+        return false;
+    switch (i->tag) {
+    case Tag::StVar:
+    case Tag::StVarSuper:
+    case Tag::MkArg:
+    case Tag::MkEnv:
+    case Tag::Return:
+    case Tag::NonLocalReturn:
+    case Tag::Force:
+        return true;
+    case Tag::Phi:
+        return !i->type.unboxable();
+    default: {}
+    }
+    return CallInstruction::CastCall(i);
+}
+
+static bool boxesArgs(Instruction* i) {
+    bool res = false;
+    i->eachArg([&](Value* v) { res = res || boxes(i, v); });
+    return res;
+}
+
+static bool allocates(Instruction* i) {
+    if (boxesArgs(i) || CallInstruction::CastCall(i))
+        return true;
+    switch (i->tag) {
+    case Tag::MkArg:
+    case Tag::MkCls:
+    case Tag::MkEnv:
+    case Tag::MaterializeEnv:
+    case Tag::DotsList:
+#define V(Name) case Tag::Name:
+        UNOP_INSTRUCTIONS(V)
+        BINOP_INSTRUCTIONS(V)
+        V(Extract1_1D)
+        V(Extract1_2D)
+        V(Extract1_3D)
+#undef V
+        return !i->type.unboxable();
+    case Tag::Extract2_1D:
+    case Tag::Extract2_2D:
+        // Elements of lists are not copied
+        return !i->type.unboxable() &&
+               i->arg(0).val()->type.maybe(PirType::num());
+    default: {}
+    }
+    return false;
+}
+
+static bool testNoAllocInLoop(ClosureVersion* f) {
+    return checkLoops(f, [&](Instruction* i) { return !allocates(i); });
+}
+
+static bool testNoBoxInLoop(ClosureVersion* f) {
+    return checkLoops(f, [&](Instruction* i) { return !boxesArgs(i); });
+}
+
+static bool testNoDeoptInLoop(ClosureVersion* f) {
+    return checkLoops(f, [&](Instruction* i) {
+        return !Assume::Cast(i) && !Deopt::Cast(i);
+    });
+}
+
+static bool testNoExternalCallsInLoop(ClosureVersion* f) {
+    return checkLoops(f, [&](Instruction* i) {
+        return !CallInstruction::CastCall(i) || CallSafeBuiltin::Cast(i);
+    });
+}
+
+static bool testNativeCallsOnly(ClosureVersion* f) {
+    return Visitor::check(f->entry, [&](Instruction* i) {
+        return !CallInstruction::CastCall(i) || StaticCall::Cast(i) ||
+               CallBuiltin::Cast(i) || CallSafeBuiltin::Cast(i);
+    });
+}
+
+// No closure is called with the environment of this function as its parent
+static bool testNoLocalClosureEnv(ClosureVersion* f) {
+    return Visitor::check(f->entry, [&](Instruction* i) {
+        Value* cls = nullptr;
+        if (auto call = StaticCall::Cast(i))
+            cls = call->runtimeClosure();
+        else if (auto call = CallInstruction::CastCall(i))
+            cls = call->tryGetClsArg();
+        auto mk = cls ? MkCls::Cast(cls->followCastsAndForce()) : nullptr;
+        return !mk || !MkEnv::Cast(mk->lexicalEnv());
+    });
+}
+
 PirCheck::Type PirCheck::parseType(const char* str) {
 #define V(Check)                                                               \
     if (strcmp(str, #Check) == 0)                                              \
@@ -30,7 +30,13 @@ namespace rir {
     V(EagerCallArgs)                                                           \
     V(LdVarVectorInFirstBB)                                                    \
     V(UnboxedExtract)                                                          \
-    V(AnAddIsNotNAOrNaN)
+    V(AnAddIsNotNAOrNaN)                                                       \
+    V(NoAllocInLoop)                                                           \
+    V(NoBoxInLoop)                                                             \
+    V(NoDeoptInLoop)                                                           \
+    V(NoExternalCallsInLoop)                                                   \
+    V(NativeCallsOnly)                                                         \
+    V(NoLocalClosureEnv)
 
 struct PirCheck {
     enum class Type : unsigned {
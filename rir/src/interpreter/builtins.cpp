@@ -257,7 +257,7 @@ SEXP tryFastSpecialCall(CallContext& call) {
 static constexpr size_t MAXARGS = 8;
 
 bool supportsFastBuiltinCall2(SEXP b, size_t nargs) {
-    if (nargs > 5)
+    if (nargs > MAXARGS)
         return false;
 
     // This is a blocklist of builtins which tamper with the argslist in some
@@ -344,52 +344,15 @@ static bool doesNotAccessEnv(SEXP b) {
 
 SEXP tryFastBuiltinCall2(CallContext& call, size_t nargs,
                          SEXP (&args)[MAXARGS]) {
-    assert(nargs <= 5);
-
-    {
-        SEXP arglist;
-        CCODE f = getBuiltin(call.callee);
-        SEXP res = nullptr;
-        auto env = doesNotAccessEnv(call.callee) ? R_BaseEnv
-                                                 : materializeCallerEnv(call);
-        switch (call.passedArgs) {
-        case 0: {
-            return f(call.ast, call.callee, R_NilValue, env);
-        }
-        case 1: {
-            FAKE_ARGS1(arglist, args[0]);
-            res = f(call.ast, call.callee, arglist, env);
-            CHECK_FAKE_ARGS1();
-            break;
-        }
-        case 2: {
-            FAKE_ARGS2(arglist, args[0], args[1]);
-            res = f(call.ast, call.callee, arglist, env);
-            CHECK_FAKE_ARGS2();
-            break;
-        }
-        case 3: {
-            FAKE_ARGS3(arglist, args[0], args[1], args[2]);
-            res = f(call.ast, call.callee, arglist, env);
-            CHECK_FAKE_ARGS3();
-            break;
-        }
-        case 4: {
-            FAKE_ARGS4(arglist, args[0], args[1], args[2], args[3]);
-            res = f(call.ast, call.callee, arglist, env);
-            CHECK_FAKE_ARGS4();
-            break;
-        }
-        case 5: {
-            FAKE_ARGS5(arglist, args[0], args[1], args[2], args[3], args[4]);
-            res = f(call.ast, call.callee, arglist, env);
-            CHECK_FAKE_ARGS5();
-            break;
-        }
-        }
-        return res;
-    }
-    return nullptr;
+    assert(nargs <= MAXARGS);
+
+    CCODE f = getBuiltin(call.callee);
+    auto env = doesNotAccessEnv(call.callee) ? R_BaseEnv
+                                             : materializeCallerEnv(call);
+    FakeArglist<MAXARGS> arglist;
+    SEXP res = f(call.ast, call.callee, arglist.init(args, nargs), env);
+    arglist.check(nargs);
+    return res;
 }
 
 SEXP tryFastBuiltinCall1(const CallContext& call, size_t nargs, bool hasAttrib,
@@ -419,9 +382,113 @@ SEXP tryFastBuiltinCall1(const CallContext& call, size_t nargs, bool hasAttrib,
         return OBJECT(args[0]) ? R_TrueValue : R_FalseValue;
     }
 
+    case blt("is.null"): {
+        if (nargs != 1)
+            return nullptr;
+        return args[0] == R_NilValue ? R_TrueValue : R_FalseValue;
+    }
+
+    case blt("is.integer"): {
+        if (nargs != 1)
+            return nullptr;
+        return TYPEOF(args[0]) == INTSXP ? R_TrueValue : R_FalseValue;
+    }
+
+    case blt("is.double"): {
+        if (nargs != 1)
+            return nullptr;
+        return TYPEOF(args[0]) == REALSXP ? R_TrueValue : R_FalseValue;
+    }
+
+    case blt("is.complex"): {
+        if (nargs != 1)
+            return nullptr;
+        return TYPEOF(args[0]) == CPLXSXP ? R_TrueValue : R_FalseValue;
+    }
+
+    case blt("is.character"): {
+        if (nargs != 1)
+            return nullptr;
+        return TYPEOF(args[0]) == STRSXP ? R_TrueValue : R_FalseValue;
+    }
+
+    case blt("is.environment"): {
+        if (nargs != 1)
+            return nullptr;
+        return TYPEOF(args[0]) == ENVSXP ? R_TrueValue : R_FalseValue;
+    }
+
+    case blt("is.list"): {
+        if (nargs != 1)
+            return nullptr;
+        return TYPEOF(args[0]) == VECSXP || TYPEOF(args[0]) == LISTSXP
+                   ? R_TrueValue
+                   : R_FalseValue;
+    }
+
+    case blt("is.pairlist"): {
+        if (nargs != 1)
+            return nullptr;
+        return TYPEOF(args[0]) == LISTSXP || TYPEOF(args[0]) == NILSXP
+                   ? R_TrueValue
+                   : R_FalseValue;
+    }
+
+    case blt("is.raw"): {
+        if (nargs != 1)
+            return nullptr;
+        return TYPEOF(args[0]) == RAWSXP ? R_TrueValue : R_FalseValue;
+    }
+
     case blt("baseenv"): {
         return R_BaseEnv;
     }
+
+    case blt("oldClass"): {
+        // S4 objects may answer with their .S3Class slot instead
+        if (nargs != 1 || IS_S4_OBJECT(args[0]))
+            return nullptr;
+        return Rf_getAttrib(args[0], R_ClassSymbol);
+    }
+    }
+
+    // Generic builtins, which only dispatch on objects
+    if (nargs == 1 && !OBJECT(args[0])) {
+        switch (call.callee->u.primsxp.offset) {
+        case blt("length"): {
+            size_t res;
+            switch (TYPEOF(args[0])) {
+            case INTSXP:
+            case REALSXP:
+            case LGLSXP:
+            case STRSXP:
+                res = XLENGTH(args[0]);
+                break;
+            default:
+                res = Rf_xlength(args[0]);
+                break;
+            }
+            if (res >= INT_MAX)
+                return Rf_ScalarReal(res);
+            return Rf_ScalarInteger(res);
+        }
+
+        case blt("names"): {
+            switch (TYPEOF(args[0])) {
+            case LGLSXP:
+            case INTSXP:
+            case REALSXP:
+            case CPLXSXP:
+            case STRSXP:
+            case VECSXP:
+            case RAWSXP:
+                return Rf_getAttrib(args[0], R_NamesSymbol);
+            default:
+                break;
+            }
+            break;
+        }
+        }
     }
 
     if (hasAttrib)
@@ -448,26 +515,6 @@ SEXP tryFastBuiltinCall1(const CallContext& call, size_t nargs, bool hasAttrib,
         return Rf_ScalarInteger(nargs);
     }
 
-    case blt("length"): {
-        if (nargs != 1)
-            return nullptr;
-
-        size_t res;
-        switch (TYPEOF(args[0])) {
-        case INTSXP:
-        case REALSXP:
-        case LGLSXP:
-        case STRSXP:
-            res = XLENGTH(args[0]);
-            break;
-        default:
-            res = Rf_xlength(args[0]);
-            break;
-        }
-        if (res >= INT_MAX)
-            return Rf_ScalarReal(res);
-        return Rf_ScalarInteger(res);
-    }
 
     case blt("c"): {
         if (nargs == 0)
@@ -1068,6 +1115,17 @@ bool supportsFastBuiltinCall(SEXP b, size_t nargs) {
     case blt("is.symbol"):
     case blt("is.expression"):
     case blt("is.object"):
+    case blt("is.null"):
+    case blt("is.integer"):
+    case blt("is.double"):
+    case blt("is.complex"):
+    case blt("is.character"):
+    case blt("is.environment"):
+    case blt("is.list"):
+    case blt("is.pairlist"):
+    case blt("is.raw"):
+    case blt("oldClass"):
+    case blt("names"):
     case blt("is.numeric"):
     case blt("is.matrix"):
     case blt("is.array"):
@@ -1105,21 +1163,26 @@ SEXP tryFastBuiltinCall(CallContext& call) {
         return nullptr;
 
     bool hasAttrib = false;
+    bool hasObject = false;
     for (size_t i = 0; i < call.suppliedArgs; ++i) {
         auto arg = call.stackArg(i);
         if (TYPEOF(arg) == PROMSXP)
             arg = evaluatePromise(arg);
         if (arg == R_UnboundValue || arg == R_MissingArg)
             return nullptr;
-        if (ATTRIB(arg) != R_NilValue)
+        if (ATTRIB(arg) != R_NilValue) {
             hasAttrib = true;
+            if (OBJECT(arg))
+                hasObject = true;
+        }
         args[i] = arg;
     }
 
     if (auto res = tryFastBuiltinCall1(call, nargs, hasAttrib, args))
         return res;
 
-    if (hasAttrib)
+    // Without objects there is no dispatch, which could leak the arglist
+    if (hasObject)
         return nullptr;
 
     if (!supportsFastBuiltinCall2(call.callee, nargs))
@@ -65,6 +65,10 @@ struct CallContext {
     Context givenContext;
     SEXP arglist = nullptr;
     bool triggerOsr = false;
+    // Per call site memo for inferCurrentContext, if the call site has one
+    BC::CallContextCache* contextCache = nullptr;
+    // Per call site memo for argument matching of named calls
+    BC::CallArgmatchCache* argmatchCache = nullptr;
 
     bool hasEagerCallee() const { return TYPEOF(callee) == BUILTINSXP; }
     bool hasNames() const { return names; }
@@ -0,0 +1,105 @@
+#include "compile_budget.h"
+#include "compiler/parameter.h"
+#include "runtime/Function.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace rir {
+
+namespace {
+// Functions are only compared by identity, a pending request might outlive
+// its function
+struct Request {
+    Function* fun;
+    unsigned long priority;
+    unsigned long cost;
+    size_t window;
+};
+} // namespace
+
+static const size_t MAX_PENDING = 64;
+
+static std::vector<Request> pending;
+static size_t window = 0;
+static unsigned long windowStart = 0;
+static unsigned long spent = 0;
+static CompileBudget::Stats counters = {0, 0, 0, 0};
+
+static void advance() {
+    auto now = Function::rdtsc();
+    if (now - windowStart < pir::Parameter::PIR_COMPILE_WINDOW)
+        return;
+    windowStart = now;
+    spent = 0;
+    window++;
+
+    auto expired =
+        std::remove_if(pending.begin(), pending.end(),
+                       [](const Request& r) { return r.window + 1 < window; });
+    counters.dropped += pending.end() - expired;
+    pending.erase(expired, pending.end());
+}
+
+bool CompileBudget::admit(Function* fun, unsigned long time) {
+    auto budget = pir::Parameter::PIR_COMPILE_BUDGET;
+    if (budget == 0) {
+        counters.admitted++;
+        return true;
+    }
+    advance();
+
+    auto self = std::find_if(pending.begin(), pending.end(),
+                             [&](const Request& r) { return r.fun == fun; });
+    auto priority = time;
+    if (self != pending.end())
+        priority += self->priority;
+
+    unsigned long reserved = 0;
+    for (auto& r : pending)
+        if (r.fun != fun && r.priority > priority)
+            reserved += r.cost;
+
+    auto cost = fun->compileCost();
+    // Functions more expensive than the whole budget get a window of their
+    // own
+    if (spent + reserved + cost <= budget || (spent == 0 && reserved == 0)) {
+        if (self != pending.end())
+            pending.erase(self);
+        counters.admitted++;
+        return true;
+    }
+
+    counters.deferred++;
+    if (self != pending.end()) {
+        self->priority = priority;
+        self->cost = cost;
+        self->window = window;
+        return false;
+    }
+    pending.push_back({fun, priority, cost, window});
+    if (pending.size() > MAX_PENDING) {
+        auto lowest = std::min_element(pending.begin(), pending.end(),
+                                       [](const Request& a, const Request& b) {
+                                           return a.priority < b.priority;
+                                       });
+        pending.erase(lowest);
+        counters.dropped++;
+    }
+    return false;
+}
+
+bool CompileBudget::isPending(Function* fun) {
+    return std::any_of(pending.begin(), pending.end(),
+                       [&](const Request& r) { return r.fun == fun; });
+}
+
+void CompileBudget::charge(unsigned long ticks) { spent += ticks; }
+
+CompileBudget::Stats CompileBudget::stats() {
+    auto res = counters;
+    res.pending = pending.size();
+    return res;
+}
+
+} // namespace rir
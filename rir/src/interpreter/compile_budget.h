@@ -0,0 +1,38 @@
+#ifndef interpreter_compile_budget_h
+#define interpreter_compile_budget_h
+
+#include <cstddef>
+
+namespace rir {
+
+struct Function;
+
+/*
+ * Limits the time spent optimizing per window of wall-clock time, such that
+ * many functions becoming hot at once do not stall the program. Requests
+ * which do not fit into the rest of the budget are deferred. Pending
+ * requests are ordered by the invocation time accumulated in their function
+ * and budget is held back for the ones ahead of a request. A pending request
+ * which is not repeated until the end of the next window is dropped.
+ */
+class CompileBudget {
+  public:
+    struct Stats {
+        size_t admitted;
+        size_t deferred;
+        size_t dropped;
+        size_t pending;
+    };
+
+    // Whether fun may be optimized now, time is its invocation time
+    static bool admit(Function* fun, unsigned long time);
+    // Whether a deferred request of fun is still pending
+    static bool isPending(Function* fun);
+    // Accounts for the ticks an admitted compilation took
+    static void charge(unsigned long ticks);
+    static Stats stats();
+};
+
+} // namespace rir
+
+#endif
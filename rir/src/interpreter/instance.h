@@ -93,11 +93,84 @@ inline size_t ostack_length() {
 
 inline R_bcstack_t* ostack_cell_at(int i) { return R_BCNodeStackTop - 1 - i; }
 
-inline SEXP ostack_at(int i) { return ostack_cell_at(i)->u.sxpval; }
+/*
+ * Cells can also hold unboxed int, logical and double scalars, tagged with
+ * their SEXPTYPE like in the GNU R bytecode interpreter (the GC skips them).
+ * Only a few instructions produce and consume those directly, everyone reading
+ * a cell as SEXP boxes it in place first.
+ */
+inline void ostack_box_cell(R_bcstack_t* cell) {
+    if (cell->tag == 0)
+        return;
+    SEXP res;
+    switch (cell->tag) {
+    case INTSXP:
+        res = Rf_ScalarInteger(cell->u.ival);
+        break;
+    case LGLSXP:
+        res = Rf_ScalarLogical(cell->u.ival);
+        break;
+    case REALSXP:
+        res = Rf_ScalarReal(cell->u.dval);
+        break;
+    default:
+        assert(false && "unexpected stack cell tag");
+        res = R_NilValue;
+    }
+    cell->u.sxpval = res;
+    cell->tag = 0;
+}
+
+inline void ostack_set_cell_int(R_bcstack_t* cell, int v) {
+    cell->u.ival = v;
+    cell->tag = INTSXP;
+}
+
+inline void ostack_set_cell_real(R_bcstack_t* cell, double v) {
+    cell->u.dval = v;
+    cell->tag = REALSXP;
+}
+
+// Reads an int scalar, boxed or not, without allocating
+inline bool ostack_cell_int(const R_bcstack_t* cell, int& res) {
+    if (cell->tag == INTSXP) {
+        res = cell->u.ival;
+        return true;
+    }
+    if (cell->tag == 0 && IS_SIMPLE_SCALAR(cell->u.sxpval, INTSXP) &&
+        INTEGER(cell->u.sxpval)[0] != NA_INTEGER) {
+        res = INTEGER(cell->u.sxpval)[0];
+        return true;
+    }
+    return false;
+}
+
+// Reads a double scalar, boxed or not, without allocating
+inline bool ostack_cell_real(const R_bcstack_t* cell, double& res) {
+    if (cell->tag == REALSXP) {
+        res = cell->u.dval;
+        return true;
+    }
+    if (cell->tag == 0 && IS_SIMPLE_SCALAR(cell->u.sxpval, REALSXP)) {
+        res = REAL(cell->u.sxpval)[0];
+        return true;
+    }
+    return false;
+}
+
+inline SEXP ostack_at(int i) {
+    auto cell = ostack_cell_at(i);
+    ostack_box_cell(cell);
+    return cell->u.sxpval;
+}
 
 inline SEXP ostack_top() { return ostack_at(0); }
 
-inline SEXP ostack_at_cell(const R_bcstack_t* cell) { return cell->u.sxpval; }
+// Used for call arguments, which never hold unboxed values
+inline SEXP ostack_at_cell(const R_bcstack_t* cell) {
+    SLOWASSERT(cell->tag == 0);
+    return cell->u.sxpval;
+}
 
 inline void ostack_set_cell(R_bcstack_t* cell, SEXP v) {
     cell->u.sxpval = v;
@@ -106,15 +179,30 @@ inline void ostack_set_cell(R_bcstack_t* cell, SEXP v) {
 
 inline void ostack_set(int i, SEXP v) { ostack_set_cell(ostack_cell_at(i), v); }
 
+// The top n values escape, eg. as arguments of a call
+inline void ostack_box(size_t n) {
+    for (size_t i = 0; i < n; ++i)
+        ostack_box_cell(ostack_cell_at(i));
+}
+
 inline void ostack_popn(size_t n) { R_BCNodeStackTop -= n; }
 
-inline SEXP ostack_pop() { return (--R_BCNodeStackTop)->u.sxpval; }
+inline SEXP ostack_pop() {
+    ostack_box_cell(R_BCNodeStackTop - 1);
+    return (--R_BCNodeStackTop)->u.sxpval;
+}
 
 inline void ostack_push(SEXP v) {
     ostack_set_cell(R_BCNodeStackTop, v);
     ++R_BCNodeStackTop;
 }
 
+// Copies a cell as is, without boxing it
+inline void ostack_push_cell(const R_bcstack_t& cell) {
+    *R_BCNodeStackTop = cell;
+    ++R_BCNodeStackTop;
+}
+
 inline void ostack_ensureSize(unsigned minFree) {
     if ((R_BCNodeStackTop + minFree) >= R_BCNodeStackEnd) {
         // TODO....
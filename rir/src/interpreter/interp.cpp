@@ -9,6 +9,7 @@
 #include "compiler/osr.h"
 #include "compiler/parameter.h"
 #include "compiler/pir/continuation_context.h"
+#include "compiler/pir/deopt_context.h"
 #include "runtime/Deoptimization.h"
 #include "runtime/LazyArglist.h"
 #include "runtime/LazyEnvironment.h"
@@ -17,8 +18,11 @@
 #include "utils/Pool.h"
 #include "utils/measuring.h"
 
+#include <algorithm>
 #include <assert.h>
 #include <deque>
+#include <functional>
+#include <iomanip>
 #include <libintl.h>
 #include <set>
 #include <unordered_set>
@@ -86,6 +90,59 @@ static void printInterp(Opcode* pc, Code* c) {
 static void printLastop() { std::cout << "> lastop\n"; }
 #endif
 
+// #define PROFILE_OPCODE_NGRAMS
+#ifdef PROFILE_OPCODE_NGRAMS
+// Counts the pairs and triples of opcodes in the order they are dispatched and
+// prints the most frequent ones at exit. Used to pick superinstructions, see
+// CodeStream::fuse for the ones there are.
+class OpcodeNgramProfile {
+    static constexpr size_t N = static_cast<size_t>(Opcode::num_of);
+    static constexpr size_t TOP = 30;
+    std::vector<size_t> bigrams = std::vector<size_t>(N * N);
+    std::vector<size_t> trigrams = std::vector<size_t>(N * N * N);
+    size_t last = 0, beforeLast = 0;
+
+    static void print(const std::vector<size_t>& counts, size_t arity) {
+        std::vector<std::pair<size_t, size_t>> top;
+        for (size_t i = 0; i < counts.size(); ++i)
+            if (counts[i])
+                top.push_back({counts[i], i});
+        auto n = std::min(top.size(), TOP);
+        std::partial_sort(top.begin(), top.begin() + n, top.end(),
+                          std::greater<std::pair<size_t, size_t>>());
+        std::cerr << "Most frequent opcode " << arity << "-grams:\n";
+        for (size_t i = 0; i < n; ++i) {
+            std::cerr << std::setw(14) << top[i].first << " ";
+            std::vector<const char*> names;
+            for (size_t j = 0, idx = top[i].second; j < arity; ++j, idx /= N)
+                names.push_back(BC::name(static_cast<Opcode>(idx % N)));
+            for (auto it = names.rbegin(); it != names.rend(); ++it)
+                std::cerr << " " << *it;
+            std::cerr << "\n";
+        }
+    }
+
+  public:
+    // Sequences starting with invalid_ span the entry of a code object
+    void count(Opcode op) {
+        auto o = static_cast<size_t>(op);
+        bigrams[last * N + o]++;
+        trigrams[(beforeLast * N + last) * N + o]++;
+        beforeLast = last;
+        last = o;
+    }
+
+    ~OpcodeNgramProfile() {
+        print(bigrams, 2);
+        print(trigrams, 3);
+    }
+};
+static OpcodeNgramProfile opcodeNgramProfile;
+#define PROFILE_OPCODE() opcodeNgramProfile.count(*pc)
+#else
+#define PROFILE_OPCODE()
+#endif
+
 static SEXP getSrcAt(Code* c, Opcode* pc) {
     unsigned sidx = c->getSrcIdxAt(pc, true);
     if (sidx == 0)
@@ -98,6 +155,39 @@ static SEXP getSrcForCall(Code* c, Opcode* pc) {
     return src_pool_at(sidx);
 }
 
+// Converts the condition of an if or while to TRUE or FALSE. pc is the start
+// of the instruction, for error reporting.
+static SEXP asBool(SEXP val, Code* c, Opcode* pc) {
+    int cond = NA_LOGICAL;
+    if (XLENGTH(val) > 1)
+        Rf_warningcall(getSrcAt(c, pc),
+                       "the condition has length > 1 and only the first "
+                       "element will be used");
+
+    if (XLENGTH(val) > 0) {
+        switch (TYPEOF(val)) {
+        case LGLSXP:
+            cond = LOGICAL(val)[0];
+            break;
+        case INTSXP:
+            cond = INTEGER(val)[0]; // relies on NA_INTEGER == NA_LOGICAL
+            break;
+        default:
+            cond = Rf_asLogical(val);
+        }
+    }
+
+    if (cond == NA_LOGICAL) {
+        const char* msg =
+            XLENGTH(val) ? (Rf_isLogical(val)
+                                ? ("missing value where TRUE/FALSE needed")
+                                : ("argument is not interpretable as logical"))
+                         : ("argument is of length zero");
+        Rf_errorcall(getSrcAt(c, pc), msg);
+    }
+    return cond ? R_TrueValue : R_FalseValue;
+}
+
 #define PC_BOUNDSCHECK(pc, c)                                                  \
     SLOWASSERT((pc) >= (c)->code() && (pc) < (c)->endCode());
 
@@ -108,19 +198,24 @@ static SEXP getSrcForCall(Code* c, Opcode* pc) {
 #define NEXT()                                                                 \
     (__extension__({                                                           \
         printInterp(pc, c);                                                    \
+        PROFILE_OPCODE();                                                      \
         goto* opAddr[static_cast<uint8_t>(advanceOpcode())];                   \
     }))
 #define LASTOP                                                                 \
     { printLastop(); }
 #else
 #define NEXT()                                                                 \
-    (__extension__({ goto* opAddr[static_cast<uint8_t>(advanceOpcode())]; }))
+    (__extension__({                                                           \
+        PROFILE_OPCODE();                                                      \
+        goto* opAddr[static_cast<uint8_t>(advanceOpcode())];                   \
+    }))
 #define LASTOP                                                                 \
     {}
 #endif
 #else
 #define BEGIN_MACHINE                                                          \
     loop:                                                                      \
+    PROFILE_OPCODE();                                                          \
     switch (advanceOpcode())
 #define INSTRUCTION(name) case Opcode::name:
 #define NEXT() goto loop
@@ -553,6 +648,101 @@ static void loopTrampoline(Code* c, SEXP env, const CallContext* callCtxt,
     Rf_endcontext(&cntxt);
 }
 
+/*
+ * Fast path for Rf_matchArgs_NR, for callees without ... where every named
+ * argument matches a formal exactly. The positions are memoized in the call
+ * site and keyed by the callee formals. On a hit we only check that the names
+ * still line up, instead of string matching all pairs. Returns nullptr when
+ * GNU R has to do the matching (partial matches, dots, errors...).
+ */
+static SEXP matchArgsCached(const CallContext& call, SEXP supplied) {
+    static constexpr size_t MAX_FORMALS = 32;
+    auto cache = call.argmatchCache;
+    if (!cache)
+        return nullptr;
+
+    SEXP formals = FORMALS(call.callee);
+    SEXP formal[MAX_FORMALS];
+    size_t nformals = 0;
+    for (auto f = formals; f != R_NilValue; f = CDR(f)) {
+        if (nformals == MAX_FORMALS || TAG(f) == R_DotsSymbol)
+            return nullptr;
+        formal[nformals++] = f;
+    }
+    size_t nsupplied = 0;
+    for (auto b = supplied; b != R_NilValue; b = CDR(b)) {
+        if (nsupplied == sizeof(cache->position) || TAG(b) == R_DotsSymbol)
+            return nullptr;
+        nsupplied++;
+    }
+
+    BC::CallArgmatchCache entry;
+    memcpy(&entry, cache, sizeof(entry));
+    bool hit = entry.formals == (uintptr_t)formals &&
+               entry.nformals == nformals;
+    if (hit) {
+        // The formals might have been collected and reallocated at the same
+        // address. Positional arguments only depend on which formals were
+        // taken by name, so checking the names is enough.
+        size_t i = 0;
+        for (auto b = supplied; b != R_NilValue; b = CDR(b), i++) {
+            if (TAG(b) != R_NilValue &&
+                TAG(formal[entry.position[i]]) != TAG(b)) {
+                hit = false;
+                break;
+            }
+        }
+    }
+
+    if (!hit) {
+        bool used[MAX_FORMALS] = {};
+        entry.formals = (uintptr_t)formals;
+        entry.nformals = nformals;
+        size_t i = 0;
+        for (auto b = supplied; b != R_NilValue; b = CDR(b), i++) {
+            if (TAG(b) == R_NilValue)
+                continue;
+            size_t j = 0;
+            while (j < nformals && TAG(formal[j]) != TAG(b))
+                j++;
+            if (j == nformals || used[j])
+                return nullptr;
+            used[j] = true;
+            entry.position[i] = j;
+        }
+        size_t j = 0;
+        i = 0;
+        for (auto b = supplied; b != R_NilValue; b = CDR(b), i++) {
+            if (TAG(b) != R_NilValue)
+                continue;
+            while (j < nformals && used[j])
+                j++;
+            if (j == nformals)
+                return nullptr;
+            used[j] = true;
+            entry.position[i] = j;
+        }
+        memcpy(cache, &entry, sizeof(entry));
+    }
+
+    // Same shape as the result of Rf_matchArgs_NR
+    SEXP actuals = R_NilValue;
+    SEXP actual[MAX_FORMALS];
+    for (size_t j = nformals; j > 0; j--) {
+        actuals = CONS_NR(R_MissingArg, actuals);
+        SET_MISSING(actuals, 1);
+        actual[j - 1] = actuals;
+    }
+    size_t i = 0;
+    for (auto b = supplied; b != R_NilValue; b = CDR(b), i++) {
+        auto a = actual[entry.position[i]];
+        SETCAR(a, CAR(b));
+        if (CAR(b) != R_MissingArg)
+            SET_MISSING(a, 0);
+    }
+    return actuals;
+}
+
 static SEXP closureArgumentAdaptor(const CallContext& call, SEXP arglist) {
     SEXP op = call.callee;
     if (FORMALS(op) == R_NilValue && arglist == R_NilValue)
@@ -573,8 +763,12 @@ static SEXP closureArgumentAdaptor(const CallContext& call, SEXP arglist) {
 
     bool noArgmatchNeeded =
         call.givenContext.includes(Assumption::StaticallyArgmatched);
-    if (!noArgmatchNeeded)
-        actuals = Rf_matchArgs_NR(FORMALS(op), actuals, call.ast);
+    if (!noArgmatchNeeded) {
+        if (auto matched = matchArgsCached(call, actuals))
+            actuals = matched;
+        else
+            actuals = Rf_matchArgs_NR(FORMALS(op), actuals, call.ast);
+    }
 
     PROTECT(newrho = Rf_NewEnvironment(FORMALS(op), actuals, CLOENV(op)));
 
@@ -601,9 +795,12 @@ static SEXP closureArgumentAdaptor(const CallContext& call, SEXP arglist) {
            assignments arguments increment REFCNT values */
         ENABLE_REFCNT(a);
 
-        Code* c = fun->defaultArg(pos++);
+        auto idx = pos++;
         if (CAR(f) != R_MissingArg) {
             if (CAR(a) == R_MissingArg) {
+                // Only ask for default args which are used, they are compiled
+                // on demand
+                Code* c = fun->defaultArg(idx);
                 assert(c != nullptr && "No more compiled formals available.");
                 SETCAR(a, createPromise(c, newrho));
                 SET_MISSING(a, 2);
@@ -663,129 +860,184 @@ SEXP getTrivialPromValue(SEXP sym, SEXP env) {
     return R_UnboundValue;
 }
 
-void inferCurrentContext(CallContext& call, size_t formalNargs) {
-    Context& given = call.givenContext;
+// What inferCurrentContext learns about a single call argument
+enum ArgKind : unsigned {
+    ArgExplicitlyMissing = 1 << 0,
+    ArgEager = 1 << 1,
+    ArgNonRefl = 1 << 2,
+    ArgNotObj = 1 << 3,
+    ArgSimpleReal = 1 << 4,
+    ArgSimpleInt = 1 << 5,
+    ArgMissingValue = 1 << 6,
+    ArgKindBits = 7,
+};
 
-    if (call.suppliedArgs <= formalNargs) {
-        given.add(Assumption::NotTooManyArguments);
-        given.numMissing(formalNargs - call.suppliedArgs);
-    }
+static unsigned argKind(CallContext& call, size_t i) {
+    SEXP arg = call.stackArg(i);
+    bool isEager = true;
+
+    // An explicitly missing arg, such as f(,1)
+    if (arg == R_MissingArg)
+        return ArgExplicitlyMissing | ArgNonRefl | ArgEager;
+
+    bool reflectionPossible = false;
+
+    if (TYPEOF(arg) == PROMSXP) {
+        auto prom = arg;
+        arg = PRVALUE(arg);
+
+        // For Lazy promises, lets try to figure out where it points to.
+        if (arg == R_UnboundValue) {
+            reflectionPossible = true;
+            isEager = false;
+            // If this is a simple promise, that just looks up an eager
+            // value we do not reset the no-reflection flag. The callee
+            // can assume that (as long as he does not trigger any other
+            // reflection) evaluating this promise does not trigger
+            // reflection either.
+            while (true) {
+                SEXP v = PRVALUE(prom);
+
+                if (v == R_MissingArg) {
+                    arg = v;
+                    reflectionPossible = false;
+                    break;
+                }
 
-    // S3 dispatch adds additional arguments to the function environment. This
-    // is unfortunately not compatible with optimized code, since in PIR we need
-    // to know all the formals of a function.
-    // TODO: make S3 dispatch a context flag, so we can compile a version of the
-    // function that expects the additional suppliedvars on the stack. For now
-    // let's just prevent calling into optimized code by removing the
-    // notTooManyArguments assumption.
-    if (call.suppliedvars != R_NilValue)
-        given.remove(Assumption::NotTooManyArguments);
+                // Let's try to find out if this promise is a trivial
+                // expression (i.e. just a name lookup) and if that lookup
+                // can be easily resolved.
+                if (v == R_UnboundValue) {
+                    if (auto sym = getSymbolIfTrivialPromise(prom))
+                        v = getTrivialPromValue(sym, PRENV(prom));
+                }
 
-    given.add(Assumption::NoExplicitlyMissingArgs);
+                if (reflectionPossible) {
+                    auto pr = Code::check(PREXPR(prom));
+                    if (pr && pr->flags.contains(Code::NoReflection))
+                        reflectionPossible = false;
+                }
 
-    auto testArg = [&](size_t i) {
-        SEXP arg = call.stackArg(i);
-        bool isEager = true;
+                // This is truly lazy and we did not manage to lookup
+                // anything
+                if (v == R_UnboundValue)
+                    break;
 
-        // An explicitly missing arg, such as f(,1)
-        if (arg == R_MissingArg) {
-            given.remove(Assumption::NoExplicitlyMissingArgs);
-            given.setNonRefl(i);
-            given.setEager(i);
-            return;
+                if (TYPEOF(v) != PROMSXP) {
+                    reflectionPossible = false;
+                    arg = v;
+                    break;
+                }
+                prom = v;
+            }
         }
+    }
 
-        bool reflectionPossible = false;
-
-        if (TYPEOF(arg) == PROMSXP) {
-            auto prom = arg;
-            arg = PRVALUE(arg);
+    assert(TYPEOF(arg) != PROMSXP);
 
-            // For Lazy promises, lets try to figure out where it points to.
-            if (arg == R_UnboundValue) {
-                reflectionPossible = true;
-                isEager = false;
-                // If this is a simple promise, that just looks up an eager
-                // value we do not reset the no-reflection flag. The callee
-                // can assume that (as long as he does not trigger any other
-                // reflection) evaluating this promise does not trigger
-                // reflection either.
-                while (true) {
-                    SEXP v = PRVALUE(prom);
+    unsigned kind = 0;
+    if (!reflectionPossible)
+        kind |= ArgNonRefl;
 
-                    if (v == R_MissingArg) {
-                        arg = v;
-                        reflectionPossible = false;
-                        break;
-                    }
+    if (isEager) {
+        kind |= ArgEager;
+        SLOWASSERT(TYPEOF(call.stackArg(i)) != PROMSXP ||
+                   PRVALUE(call.stackArg(i)) != R_UnboundValue);
+    }
 
-                    // Let's try to find out if this promise is a trivial
-                    // expression (i.e. just a name lookup) and if that lookup
-                    // can be easily resolved.
-                    if (v == R_UnboundValue) {
-                        if (auto sym = getSymbolIfTrivialPromise(prom))
-                            v = getTrivialPromValue(sym, PRENV(prom));
-                    }
+    // Without isEager, these are the results of executing a trivial
+    // expression, given no reflective change happens.
+    if (arg != R_UnboundValue && arg != R_MissingArg) {
+        if (!Rf_isObject(arg))
+            kind |= ArgNotObj;
+        if (IS_SIMPLE_SCALAR(arg, REALSXP))
+            kind |= ArgSimpleReal;
+        if (IS_SIMPLE_SCALAR(arg, INTSXP))
+            kind |= ArgSimpleInt;
+    }
 
-                    if (reflectionPossible) {
-                        auto pr = Code::check(PREXPR(prom));
-                        if (pr && pr->flags.contains(Code::NoReflection))
-                            reflectionPossible = false;
-                    }
+    if (arg == R_MissingArg)
+        kind |= ArgMissingValue;
+    return kind;
+}
 
-                    // This is truly lazy and we did not manage to lookup
-                    // anything
-                    if (v == R_UnboundValue)
-                        break;
+static void applyArgKind(Context& given, size_t i, unsigned kind) {
+    if (kind & ArgExplicitlyMissing)
+        given.remove(Assumption::NoExplicitlyMissingArgs);
+    if (kind & ArgNonRefl)
+        given.setNonRefl(i);
+    if (kind & ArgEager)
+        given.setEager(i);
+    if (kind & ArgNotObj)
+        given.setNotObj(i);
+    if (kind & ArgSimpleReal)
+        given.setSimpleReal(i);
+    if (kind & ArgSimpleInt)
+        given.setSimpleInt(i);
+    if (kind & ArgMissingValue)
+        given.resetNotObj(i);
+}
 
-                    if (TYPEOF(v) != PROMSXP) {
-                        reflectionPossible = false;
-                        arg = v;
-                        break;
-                    }
-                    prom = v;
-                }
-            }
-        }
+void inferCurrentContext(CallContext& call, size_t formalNargs) {
+    Context& given = call.givenContext;
+    auto sig =
+        DispatchTable::unpack(BODY(call.callee))->baseline()->signature();
 
-        assert(TYPEOF(arg) != PROMSXP);
+    // The inferred context only depends on the (constant) given context of
+    // the call site, the shape of the callee signature and what we learn
+    // about every argument. If all of that fits into a fingerprint, the
+    // last result of this call site can be reused.
+    uint64_t fingerprint = 0;
+    auto cache = call.contextCache;
+    if (cache && !call.hasNames() && call.suppliedvars == R_NilValue &&
+        call.suppliedArgs <= Context::NUM_TYPED_ARGS && formalNargs < 0xff &&
+        (!sig.hasDotsFormals || sig.dotsPosition < 0xff)) {
+        fingerprint = 1ul << 63;
+        fingerprint |= formalNargs;
+        fingerprint |= (sig.hasDotsFormals ? sig.dotsPosition : 0xff) << 8;
+        fingerprint |= call.suppliedArgs << 16;
+    }
 
-        if (!reflectionPossible) {
-            given.setNonRefl(i);
+    unsigned kinds[Context::NUM_TYPED_ARGS];
+    if (fingerprint) {
+        for (size_t i = 0; i < call.suppliedArgs; ++i) {
+            kinds[i] = argKind(call, i);
+            fingerprint |= (uint64_t)kinds[i] << (19 + i * ArgKindBits);
         }
-
-        if (isEager) {
-            given.setEager(i);
-            SLOWASSERT(TYPEOF(call.stackArg(i)) != PROMSXP ||
-                       PRVALUE(call.stackArg(i)) != R_UnboundValue);
+        BC::CallContextCache entry;
+        memcpy(&entry, cache, sizeof(entry));
+        if (entry.fingerprint == fingerprint) {
+            given = entry.inferred;
+            return;
         }
+    }
 
-        // Without isEager, these are the results of executing a trivial
-        // expression, given no reflective change happens.
-        if (arg != R_UnboundValue && arg != R_MissingArg) {
-            if (!Rf_isObject(arg))
-                given.setNotObj(i);
-            if (IS_SIMPLE_SCALAR(arg, REALSXP))
-                given.setSimpleReal(i);
-            if (IS_SIMPLE_SCALAR(arg, INTSXP))
-                given.setSimpleInt(i);
-        }
+    if (call.suppliedArgs <= formalNargs) {
+        given.add(Assumption::NotTooManyArguments);
+        given.numMissing(formalNargs - call.suppliedArgs);
+    }
 
-        if (arg == R_MissingArg)
-            given.resetNotObj(i);
-    };
+    // S3 dispatch adds additional arguments to the function environment. This
+    // is unfortunately not compatible with optimized code, since in PIR we need
+    // to know all the formals of a function.
+    // TODO: make S3 dispatch a context flag, so we can compile a version of the
+    // function that expects the additional suppliedvars on the stack. For now
+    // let's just prevent calling into optimized code by removing the
+    // notTooManyArguments assumption.
+    if (call.suppliedvars != R_NilValue)
+        given.remove(Assumption::NotTooManyArguments);
+
+    given.add(Assumption::NoExplicitlyMissingArgs);
 
     bool tryArgmatch = !given.includes(Assumption::StaticallyArgmatched);
     given.add(Assumption::CorrectOrderOfArguments);
-    auto sig =
-        DispatchTable::unpack(BODY(call.callee))->baseline()->signature();
     if (tryArgmatch && given.includes(Assumption::NotTooManyArguments) &&
         ((!sig.hasDotsFormals) || (call.suppliedArgs <= sig.dotsPosition)))
         given.add(Assumption::StaticallyArgmatched);
 
     SEXP formals = FORMALS(call.callee);
     for (size_t i = 0; i < call.suppliedArgs; ++i) {
-        testArg(i);
+        applyArgKind(given, i, fingerprint ? kinds[i] : argKind(call, i));
         if (call.hasNames()) {
             auto name = call.name(i);
             if (name != R_NilValue && name != TAG(formals)) {
@@ -796,6 +1048,11 @@ void inferCurrentContext(CallContext& call, size_t formalNargs) {
             formals = CDR(formals);
         }
     }
+
+    if (fingerprint) {
+        BC::CallContextCache entry{fingerprint, given};
+        memcpy(cache, &entry, sizeof(entry));
+    }
 }
 
 // Watch out: this changes call.nargs! To clean up after the call, you need to
@@ -821,8 +1078,27 @@ const unsigned pir::Parameter::PIR_OPT_TIME =
     getenv("PIR_OPT_TIME") ? atoi(getenv("PIR_OPT_TIME")) : 3e6;
 const unsigned pir::Parameter::PIR_REOPT_TIME =
     getenv("PIR_REOPT_TIME") ? atoi(getenv("PIR_REOPT_TIME")) : 5e7;
+// Instead of the fixed warmup, optimize functions once the time they are
+// expected to save exceeds the cost of compiling them
+const bool pir::Parameter::PIR_ADAPTIVE_WARMUP =
+    getenv("PIR_ADAPTIVE_WARMUP") ? atoi(getenv("PIR_ADAPTIVE_WARMUP")) : 0;
+// Percentage of the time spent in the baseline saved by optimizing
+const unsigned pir::Parameter::PIR_OPT_BENEFIT =
+    getenv("PIR_OPT_BENEFIT") ? atoi(getenv("PIR_OPT_BENEFIT")) : 50;
+// Estimated compile time per byte of bytecode, before the first compilation
+const unsigned pir::Parameter::PIR_COMPILE_COST =
+    getenv("PIR_COMPILE_COST") ? atoi(getenv("PIR_COMPILE_COST")) : 3e4;
+// Ticks which may be spent optimizing per window, 0 for no limit
+unsigned pir::Parameter::PIR_COMPILE_BUDGET =
+    getenv("PIR_COMPILE_BUDGET") ? atoi(getenv("PIR_COMPILE_BUDGET"))
+    : pir::Parameter::PIR_ADAPTIVE_WARMUP ? 1.5e9
+                                          : 0;
+const unsigned pir::Parameter::PIR_COMPILE_WINDOW =
+    getenv("PIR_COMPILE_WINDOW") ? atoi(getenv("PIR_COMPILE_WINDOW")) : 3e9;
 const unsigned pir::Parameter::DEOPT_ABANDON =
     getenv("PIR_DEOPT_ABANDON") ? atoi(getenv("PIR_DEOPT_ABANDON")) : 12;
+const unsigned pir::Parameter::FEEDBACK_FREEZE =
+    getenv("PIR_FEEDBACK_FREEZE") ? atoi(getenv("PIR_FEEDBACK_FREEZE")) : 500;
 
 static unsigned serializeCounter = 0;
 
@@ -1010,6 +1286,12 @@ SEXP doCall(CallContext& call, bool popArgs) {
                 }
             }
         }
+        // Once an optimized version has been running for a while without
+        // deopts the feedback of the baseline is good enough
+        if (fun->isOptimized() && pir::Parameter::FEEDBACK_FREEZE &&
+            fun->invocationCount() == pir::Parameter::FEEDBACK_FREEZE)
+            table->baseline()->freezeFeedback();
+
         bool needsEnv = fun->signature().envCreation ==
                         FunctionSignature::Environment::CallerProvided;
 
@@ -1342,6 +1624,65 @@ enum class Unop { PLUSOP, MINUSOP };
         }                                                                      \
     } while (false)
 
+// Scalar arithmetic on int or double operands, which can be unboxed stack
+// cells. The result stays unboxed on the stack until someone reads it as SEXP.
+// Integer overflow takes the slow path, which warns.
+#define DO_UNBOXED_BINOP(op, op2)                                              \
+    do {                                                                       \
+        R_bcstack_t* lcell = ostack_cell_at(1);                                \
+        R_bcstack_t* rcell = ostack_cell_at(0);                                \
+        int li, ri;                                                            \
+        double lr, rr;                                                         \
+        if (ostack_cell_int(lcell, li) && ostack_cell_int(rcell, ri)) {        \
+            Rboolean naflag = FALSE;                                           \
+            int res = NA_INTEGER;                                              \
+            switch (op2) {                                                     \
+            case Binop::PLUSOP:                                                \
+                res = R_integer_plus(li, ri, &naflag);                         \
+                break;                                                         \
+            case Binop::MINUSOP:                                               \
+                res = R_integer_minus(li, ri, &naflag);                        \
+                break;                                                         \
+            case Binop::TIMESOP:                                               \
+                res = R_integer_times(li, ri, &naflag);                        \
+                break;                                                         \
+            }                                                                  \
+            if (!naflag) {                                                     \
+                ostack_popn(1);                                                \
+                ostack_set_cell_int(lcell, res);                               \
+                R_Visible = (Rboolean) true;                                   \
+                NEXT();                                                        \
+            }                                                                  \
+        } else if (ostack_cell_real(lcell, lr) &&                              \
+                   ostack_cell_real(rcell, rr)) {                              \
+            ostack_popn(1);                                                    \
+            ostack_set_cell_real(lcell, (lr == NA_REAL || rr == NA_REAL)       \
+                                            ? NA_REAL                          \
+                                            : lr op rr);                       \
+            R_Visible = (Rboolean) true;                                       \
+            NEXT();                                                            \
+        }                                                                      \
+    } while (false)
+
+// Comparison of int or double operands, which can be unboxed stack cells
+#define DO_UNBOXED_RELOP(op)                                                   \
+    do {                                                                       \
+        R_bcstack_t* lcell = ostack_cell_at(1);                                \
+        R_bcstack_t* rcell = ostack_cell_at(0);                                \
+        int li, ri;                                                            \
+        double lr, rr;                                                         \
+        if (ostack_cell_int(lcell, li) && ostack_cell_int(rcell, ri)) {        \
+            ostack_popn(2);                                                    \
+            ostack_push(li op ri ? R_TrueValue : R_FalseValue);                \
+            NEXT();                                                            \
+        } else if (ostack_cell_real(lcell, lr) &&                              \
+                   ostack_cell_real(rcell, rr) && !ISNAN(lr) && !ISNAN(rr)) {  \
+            ostack_popn(2);                                                    \
+            ostack_push(lr op rr ? R_TrueValue : R_FalseValue);                \
+            NEXT();                                                            \
+        }                                                                      \
+    } while (false)
+
 static double myfloor(double x1, double x2) {
     double q = x1 / x2, tmp;
 
@@ -1678,6 +2019,103 @@ void deoptFramesWithContext(const CallContext* callCtxt,
     ostack_push(res);
 }
 
+/*
+ * Resumes one frame of an inlined deopt with a deoptless continuation, or in
+ * the interpreter if none can be compiled. The stack of the frame is on top
+ * of the ostack, its (lazy) environment already popped.
+ */
+static SEXP deoptlessResumeFrame(rir::Code* c, const CallContext& call,
+                                 const FrameInfo& f, size_t stackSize,
+                                 SEXP env, RCNTXT* cntxt, bool inlinee,
+                                 const DeoptReason& reason, SEXP trigger) {
+    auto base = ostack_cell_at((long)stackSize - 1);
+    auto le = LazyEnvironment::check(env);
+    assert(le && !le->materialized());
+
+    if (inlinee) {
+        // The context belongs to the native caller, which we will not return
+        // to. Longjumps targeting it have to end up here instead.
+        cntxt->nodestack = base;
+        if ((SETJMP(cntxt->cjmpbuf))) {
+            if (R_ReturnedValue == R_RestartToken) {
+                cntxt->callflag = CTXT_RETURN; /* turn restart off */
+                R_ReturnedValue = R_NilValue;  /* remove restart token */
+                if (LazyEnvironment::check(cntxt->cloenv))
+                    cntxt->cloenv = materialize(cntxt->cloenv);
+                return evalRirCode(f.code, cntxt->cloenv, &call);
+            }
+            return R_ReturnedValue;
+        }
+    }
+
+    pir::DeoptContext ctx(f.pc, le->nargs, nullptr, le, false, base, stackSize,
+                          reason, trigger);
+    if (auto fun = pir::OSR::deoptlessDispatch(cntxt->callfun, c, ctx)) {
+        // Deoptless wants the env as individual arguments on the stack
+        for (size_t i = 0; i < le->nargs; ++i)
+            ostack_push(le->getArg(i));
+        auto code = fun->body();
+        auto res = code->nativeCode()(code, base, symbol::delayedEnv,
+                                      cntxt->callfun);
+        R_BCNodeStackTop = base;
+        return res;
+    }
+
+    env = materialize(env);
+    cntxt->cloenv = env;
+    return evalRirCode(f.code, env, &call, f.pc, nullptr);
+}
+
+SEXP deoptlessInlinedFrames(rir::Code* c, const CallContext& call,
+                            DeoptMetadata* m, const DeoptReason& reason,
+                            SEXP trigger, RCNTXT** outerContext) {
+    // Every frame needs a not yet materialized environment and its own
+    // function context, directly nested in the one of the next outer frame.
+    std::vector<RCNTXT*> contexts;
+    RCNTXT* expected = (RCNTXT*)R_GlobalContext;
+    size_t offset = 0;
+    for (size_t i = 0; i < m->numFrames; ++i) {
+        const auto& f = m->frames[i];
+        auto env = ostack_at(offset);
+        auto le = LazyEnvironment::check(env);
+        if (f.inPromise || !le || le->materialized() ||
+            le->nargs > pir::DeoptContext::MAX_ENV ||
+            f.stackSize + (i > 0) > pir::DeoptContext::MAX_STACK)
+            return nullptr;
+        auto cntxt = findFunctionContextFor(env);
+        if (!cntxt || cntxt != expected)
+            return nullptr;
+        auto closure = cntxt->callfun;
+        if (TYPEOF(closure) != CLOSXP || !DispatchTable::check(BODY(closure)) ||
+            DispatchTable::unpack(BODY(closure))->baseline()->body() != f.code)
+            return nullptr;
+        contexts.push_back(cntxt);
+        expected = cntxt->nextcontext;
+        offset += f.stackSize + 1;
+    }
+
+    // Resume the frames innermost first, each result goes on top of the stack
+    // of the next outer frame, like a return from the inlined call.
+    SEXP res = nullptr;
+    DeoptReason unknown({}, DeoptReason::Unknown);
+    for (size_t i = 0; i < m->numFrames; ++i) {
+        const auto& f = m->frames[i];
+        bool innermost = i == 0;
+        bool outermost = i == m->numFrames - 1;
+        SEXP env = ostack_pop();
+        if (!innermost)
+            ostack_push(res);
+        res = deoptlessResumeFrame(c, call, f, f.stackSize + !innermost, env,
+                                   contexts[i], !outermost,
+                                   innermost ? reason : unknown,
+                                   innermost ? trigger : R_NilValue);
+        if (!outermost)
+            endClosureContext(contexts[i], res);
+    }
+    *outerContext = contexts.back();
+    return res;
+}
+
 size_t expandDotDotDotCallArgs(size_t n, Immediate* names_, SEXP env,
                                bool explicitDots) {
     Protect p;
@@ -1889,6 +2327,8 @@ static SEXP osr(const CallContext* callCtxt, R_bcstack_t* basePtr, SEXP env,
         !pir::Parameter::RIR_SERIALIZE_CHAOS && pir::Parameter::ENABLE_OSR) {
         long size = R_BCNodeStackTop - basePtr;
         assert(size >= 0);
+        // The continuation reads the stack as SEXPs
+        ostack_box(size);
         auto l = Rf_length(FRAME(env));
         auto dt = DispatchTable::check(BODY(callCtxt->callee));
         if (dt &&
@@ -1936,6 +2376,10 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
 
     R_bcstack_t* basePtr = nullptr;
 
+    // Checked once per invocation, not on every record instruction. Freezing
+    // only takes effect for later invocations.
+    bool recordFeedback = !c->function()->feedbackFrozen();
+
     BindingCache* bindingCache;
     if (cache) {
         bindingCache = cache;
@@ -2307,24 +2751,30 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
 
         INSTRUCTION(record_call_) {
             ObservedCallees* feedback = (ObservedCallees*)pc;
-            SEXP callee = ostack_top();
-            feedback->record(c, callee);
+            if (recordFeedback) {
+                SEXP callee = ostack_top();
+                feedback->record(c, callee);
+            }
             pc += sizeof(ObservedCallees);
             NEXT();
         }
 
         INSTRUCTION(record_test_) {
             ObservedTest* feedback = (ObservedTest*)pc;
-            SEXP t = ostack_top();
-            feedback->record(t);
+            if (recordFeedback) {
+                SEXP t = ostack_top();
+                feedback->record(t);
+            }
             pc += sizeof(ObservedTest);
             NEXT();
         }
 
         INSTRUCTION(record_type_) {
             ObservedValues* feedback = (ObservedValues*)pc;
-            SEXP t = ostack_top();
-            feedback->record(t);
+            if (recordFeedback && !feedback->saturated()) {
+                SEXP t = ostack_top();
+                feedback->record(t);
+            }
             pc += sizeof(ObservedValues);
             NEXT();
         }
@@ -2342,10 +2792,14 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
             advanceImmediate();
             Context given(pc);
             pc += sizeof(Context);
+            auto contextCache = (BC::CallContextCache*)pc;
+            pc += sizeof(BC::CallContextCache);
 
+            ostack_box(n);
             CallContext call(ArglistOrder::NOT_REORDERED, c, ostack_at(n), n,
                              ast, ostack_cell_at((long)n - 1), env, R_NilValue,
                              given);
+            call.contextCache = contextCache;
             SEXP res = doCall(call);
             ostack_popn(call.passedArgs + 1);
             ostack_push(res);
@@ -2377,9 +2831,13 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
             pc += sizeof(Context);
             auto names = (Immediate*)pc;
             advanceImmediateN(n);
+            auto argmatch = (BC::CallArgmatchCache*)pc;
+            pc += sizeof(BC::CallArgmatchCache);
+            ostack_box(n);
             CallContext call(ArglistOrder::NOT_REORDERED, c, ostack_at(n), n,
                              ast, ostack_cell_at((long)n - 1), names, env,
                              R_NilValue, given);
+            call.argmatchCache = argmatch;
             SEXP res = doCall(call);
             ostack_popn(call.passedArgs + 1);
             ostack_push(res);
@@ -2429,6 +2887,7 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
                     names = (Immediate*)DATAPTR(namesStore);
                 pushed = 1;
             }
+            ostack_box(n);
             CallContext call(ArglistOrder::NOT_REORDERED, c, callee, n, ast,
                              ostack_cell_at((long)n - 1), names, env,
                              R_NilValue, given);
@@ -2461,6 +2920,7 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
             advanceImmediate();
             SEXP callee = cp_pool_at(readImmediate());
             advanceImmediate();
+            ostack_box(n);
             CallContext call(ArglistOrder::NOT_REORDERED, c, callee, n, ast,
                              ostack_cell_at((long)n - 1), env, R_NilValue,
                              Context());
@@ -2513,12 +2973,14 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
         INSTRUCTION(mk_eager_promise_) {
             Immediate id = readImmediate();
             advanceImmediate();
-            SEXP prom = Rf_mkPROMISE(c->getPromise(id)->container(), env);
-            SEXP val = ostack_pop();
+            // Boxed before the promise is allocated, the value stays on the
+            // stack until the promise holds it
+            SEXP val = ostack_top();
             assert(TYPEOF(val) != PROMSXP);
+            SEXP prom = Rf_mkPROMISE(c->getPromise(id)->container(), env);
             ENSURE_NAMEDMAX(val);
             SET_PRVALUE(prom, val);
-            ostack_push(prom);
+            ostack_set(0, prom);
             NEXT();
         }
 
@@ -2549,18 +3011,18 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
         }
 
         INSTRUCTION(dup_) {
-            ostack_push(ostack_top());
+            ostack_push_cell(*ostack_cell_at(0));
             NEXT();
         }
 
         INSTRUCTION(dup2_) {
-            ostack_push(ostack_at(1));
-            ostack_push(ostack_at(1));
+            ostack_push_cell(*ostack_cell_at(1));
+            ostack_push_cell(*ostack_cell_at(1));
             NEXT();
         }
 
         INSTRUCTION(pop_) {
-            ostack_pop();
+            ostack_popn(1);
             NEXT();
         }
 
@@ -2572,10 +3034,9 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
         }
 
         INSTRUCTION(swap_) {
-            SEXP lhs = ostack_pop();
-            SEXP rhs = ostack_pop();
-            ostack_push(lhs);
-            ostack_push(rhs);
+            R_bcstack_t lhs = *ostack_cell_at(0);
+            *ostack_cell_at(0) = *ostack_cell_at(1);
+            *ostack_cell_at(1) = lhs;
             NEXT();
         }
 
@@ -2583,12 +3044,12 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
             Immediate i = readImmediate();
             advanceImmediate();
             R_bcstack_t* pos = ostack_cell_at(0);
-            SEXP val = pos->u.sxpval;
+            R_bcstack_t val = *pos;
             while (i--) {
-                pos->u.sxpval = (pos - 1)->u.sxpval;
+                *pos = *(pos - 1);
                 pos--;
             }
-            pos->u.sxpval = val;
+            *pos = val;
             NEXT();
         }
 
@@ -2596,34 +3057,31 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
             Immediate i = readImmediate();
             advanceImmediate();
             R_bcstack_t* pos = ostack_cell_at(i);
-            SEXP val = pos->u.sxpval;
+            R_bcstack_t val = *pos;
             while (i--) {
-                pos->u.sxpval = (pos + 1)->u.sxpval;
+                *pos = *(pos + 1);
                 pos++;
             }
-            pos->u.sxpval = val;
+            *pos = val;
             NEXT();
         }
 
         INSTRUCTION(pull_) {
             Immediate i = readImmediate();
             advanceImmediate();
-            SEXP val = ostack_at(i);
-            ostack_push(val);
+            ostack_push_cell(*ostack_cell_at(i));
             NEXT();
         }
 
+        // The loop counter of for loops stays unboxed
         INSTRUCTION(inc_) {
-            SEXP val = ostack_top();
-            SLOWASSERT(TYPEOF(val) == INTSXP);
-            if (MAYBE_REFERENCED(val)) {
-                int i = INTEGER(val)[0];
-                ostack_pop();
-                SEXP n = Rf_allocVector(INTSXP, 1);
-                INTEGER(n)[0] = i + 1;
-                ostack_push(n);
+            R_bcstack_t* cell = ostack_cell_at(0);
+            if (cell->tag == INTSXP) {
+                cell->u.ival++;
             } else {
-                INTEGER(val)[0]++;
+                SEXP val = cell->u.sxpval;
+                SLOWASSERT(TYPEOF(val) == INTSXP);
+                ostack_set_cell_int(cell, INTEGER(val)[0] + 1);
             }
             NEXT();
         }
@@ -2674,6 +3132,7 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
         }
 
         INSTRUCTION(add_) {
+            DO_UNBOXED_BINOP(+, Binop::PLUSOP);
             SEXP lhs = ostack_at(1);
             SEXP rhs = ostack_at(0);
             SEXP res = nullptr;
@@ -2682,6 +3141,7 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
         }
 
         INSTRUCTION(sub_) {
+            DO_UNBOXED_BINOP(-, Binop::MINUSOP);
             SEXP lhs = ostack_at(1);
             SEXP rhs = ostack_at(0);
             SEXP res = nullptr;
@@ -2690,6 +3150,7 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
         }
 
         INSTRUCTION(mul_) {
+            DO_UNBOXED_BINOP(*, Binop::TIMESOP);
             SEXP lhs = ostack_at(1);
             SEXP rhs = ostack_at(0);
             SEXP res = nullptr;
@@ -2855,6 +3316,7 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
         }
 
         INSTRUCTION(eq_) {
+            DO_UNBOXED_RELOP(==);
             SEXP lhs = ostack_at(1);
             SEXP rhs = ostack_at(0);
             SEXP res = nullptr;
@@ -2866,6 +3328,7 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
 
         INSTRUCTION(ne_) {
             assert(R_PPStackTop >= 0);
+            DO_UNBOXED_RELOP(!=);
             SEXP lhs = ostack_at(1);
             SEXP rhs = ostack_at(0);
             SEXP res = nullptr;
@@ -2876,6 +3339,7 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
         }
 
         INSTRUCTION(lt_) {
+            DO_UNBOXED_RELOP(<);
             SEXP lhs = ostack_at(1);
             SEXP rhs = ostack_at(0);
             SEXP res = nullptr;
@@ -2886,6 +3350,7 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
         }
 
         INSTRUCTION(le_) {
+            DO_UNBOXED_RELOP(<=);
             SEXP lhs = ostack_at(1);
             SEXP rhs = ostack_at(0);
             SEXP res = nullptr;
@@ -2896,6 +3361,7 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
         }
 
         INSTRUCTION(gt_) {
+            DO_UNBOXED_RELOP(>);
             SEXP lhs = ostack_at(1);
             SEXP rhs = ostack_at(0);
             SEXP res = nullptr;
@@ -2906,6 +3372,7 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
         }
 
         INSTRUCTION(ge_) {
+            DO_UNBOXED_RELOP(>=);
             SEXP lhs = ostack_at(1);
             SEXP rhs = ostack_at(0);
             SEXP res = nullptr;
@@ -2916,6 +3383,8 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
         }
 
         INSTRUCTION(lgl_and_) {
+            // Box before popping, so the first value stays protected
+            ostack_box(2);
             SEXP s2 = ostack_pop();
             SEXP s1 = ostack_pop();
             assert(TYPEOF(s2) == LGLSXP);
@@ -2934,6 +3403,7 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
         }
 
         INSTRUCTION(lgl_or_) {
+            ostack_box(2);
             SEXP s2 = ostack_pop();
             SEXP s1 = ostack_pop();
             assert(TYPEOF(s2) == LGLSXP);
@@ -3003,6 +3473,7 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
         }
 
         INSTRUCTION(identical_noforce_) {
+            ostack_box(2);
             SEXP rhs = ostack_pop();
             SEXP lhs = ostack_pop();
             // This instruction does not force, but we should still compare
@@ -3050,40 +3521,9 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
         }
 
         INSTRUCTION(asbool_) {
-            SEXP val = ostack_top();
-            int cond = NA_LOGICAL;
-            if (XLENGTH(val) > 1)
-                Rf_warningcall(
-                    getSrcAt(c, pc - 1),
-                    "the condition has length > 1 and only the first "
-                    "element will be used");
-
-            if (XLENGTH(val) > 0) {
-                switch (TYPEOF(val)) {
-                case LGLSXP:
-                    cond = LOGICAL(val)[0];
-                    break;
-                case INTSXP:
-                    cond =
-                        INTEGER(val)[0]; // relies on NA_INTEGER == NA_LOGICAL
-                    break;
-                default:
-                    cond = Rf_asLogical(val);
-                }
-            }
-
-            if (cond == NA_LOGICAL) {
-                const char* msg =
-                    XLENGTH(val)
-                        ? (Rf_isLogical(val)
-                               ? ("missing value where TRUE/FALSE needed")
-                               : ("argument is not interpretable as logical"))
-                        : ("argument is of length zero");
-                Rf_errorcall(getSrcAt(c, pc - 1), msg);
-            }
-
+            SEXP res = asBool(ostack_top(), c, pc - 1);
             ostack_pop();
-            ostack_push(cond ? R_TrueValue : R_FalseValue);
+            ostack_push(res);
             NEXT();
         }
 
@@ -3105,6 +3545,7 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
         }
 
         INSTRUCTION(colon_cast_rhs_) {
+            ostack_box(2);
             SEXP rhs = ostack_pop();
             SEXP newLhs = ostack_top();
             SEXP newRhs = colonCastRhs(newLhs, rhs);
@@ -3189,6 +3630,20 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
             NEXT();
         }
 
+        INSTRUCTION(asbool_brtrue_) {
+            Opcode* start = pc - 1;
+            JumpOffset offset = readJumpOffset();
+            advanceJump();
+            SEXP cond = asBool(ostack_top(), c, start);
+            ostack_pop();
+            if (cond == R_TrueValue) {
+                checkUserInterrupt();
+                pc += offset;
+            }
+            PC_BOUNDSCHECK(pc, c);
+            NEXT();
+        }
+
         INSTRUCTION(br_) {
             JumpOffset offset = readJumpOffset();
             advanceJump();
@@ -3294,11 +3749,21 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
 
         INSTRUCTION(extract2_1_) {
             SEXP val = ostack_at(1);
-            SEXP idx = ostack_at(0);
+            SEXP idx = nullptr;
             SEXP res = nullptr;
             int i = -1;
 
-            if (ATTRIB(val) != R_NilValue || ATTRIB(idx) != R_NilValue)
+            if (ATTRIB(val) != R_NilValue)
+                goto fallback;
+
+            // Indexing with the unboxed counter of a for loop
+            if (ostack_cell_at(0)->tag == INTSXP) {
+                i = ostack_cell_at(0)->u.ival - 1;
+                goto index;
+            }
+
+            idx = ostack_at(0);
+            if (ATTRIB(idx) != R_NilValue)
                 goto fallback;
 
             switch (TYPEOF(idx)) {
@@ -3321,6 +3786,7 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
                 goto fallback;
             }
 
+        index:
             if (i >= XLENGTH(val) || i < 0)
                 goto fallback;
 
@@ -3359,6 +3825,7 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
 
         // ---------
         fallback : {
+            idx = ostack_at(0);
             SEXP args = CONS_NR(val, CONS_NR(idx, R_NilValue));
             ostack_push(args);
             if (Rf_isObject(val)) {
@@ -3791,8 +4258,10 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
         }
 
         INSTRUCTION(set_names_) {
-            SEXP names = ostack_pop();
-            Rf_setAttrib(ostack_top(), R_NamesSymbol, names);
+            // Both stay on the stack, boxing the vector can allocate
+            SEXP names = ostack_at(0);
+            Rf_setAttrib(ostack_at(1), R_NamesSymbol, names);
+            ostack_popn(1);
             NEXT();
         }
 
@@ -3814,11 +4283,11 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
             SEXP seq = ostack_at(0);
             // TODO: we should extract the length just once at the begining of
             // the loop and generally have somthing more clever here...
-            SEXP value = Rf_allocVector(INTSXP, 1);
+            int length;
             if (Rf_isVector(seq)) {
-                INTEGER(value)[0] = LENGTH(seq);
+                length = LENGTH(seq);
             } else if (Rf_isList(seq) || Rf_isNull(seq)) {
-                INTEGER(value)[0] = Rf_length(seq);
+                length = Rf_length(seq);
             } else {
                 Rf_errorcall(R_NilValue, "invalid for() loop sequence");
             }
@@ -3836,7 +4305,8 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
                 ostack_set(0, seq);
             }
             ENSURE_NAMEDMAX(seq);
-            ostack_push(value);
+            // Allocated last, stripping the object flag can allocate too
+            ostack_push(Rf_ScalarInteger(length));
             NEXT();
         }
 
@@ -3851,8 +4321,9 @@ SEXP evalRirCode(Code* c, SEXP env, const CallContext* callCtxt,
         }
 
         INSTRUCTION(ensure_named_) {
-            SEXP val = ostack_top();
-            ENSURE_NAMED(val);
+            // Unboxed values are copies anyway
+            if (ostack_cell_at(0)->tag == 0)
+                ENSURE_NAMED(ostack_top());
             NEXT();
         }
 
@@ -3,6 +3,7 @@
 
 #include "builtins.h"
 #include "call_context.h"
+#include "compile_budget.h"
 #include "instance.h"
 
 #include "compiler/parameter.h"
@@ -70,21 +71,36 @@ inline bool RecompileHeuristic(Function* fun,
     auto abandon =
         funMaybeDisabled->deoptCount() >= pir::Parameter::DEOPT_ABANDON;
 
-    auto wt = fun->isOptimized() ? pir::Parameter::PIR_REOPT_TIME
-                                 : pir::Parameter::PIR_OPT_TIME;
+    unsigned long wt = pir::Parameter::PIR_OPT_TIME;
+    if (fun->isOptimized()) {
+        wt = pir::Parameter::PIR_REOPT_TIME;
+    } else if (pir::Parameter::PIR_ADAPTIVE_WARMUP) {
+        // Assuming the function keeps being called as often as it was so
+        // far, optimizing saves a fraction of the time spent in it. Optimize
+        // as soon as that outweighs the compile time.
+        auto benefit = pir::Parameter::PIR_OPT_BENEFIT
+                           ? pir::Parameter::PIR_OPT_BENEFIT
+                           : 1;
+        wt = fun->compileCost() * 100 / benefit;
+        // The invocation time stops growing there
+        if (wt >= Function::MAX_TIME_MEASURE)
+            wt = Function::MAX_TIME_MEASURE - 1;
+    }
     if (fun->invocationCount() >= 3 && fun->invocationTime() > wt) {
+        auto time = fun->invocationTime();
         fun->clearInvocationTime();
-        return !abandon;
+        return !abandon && CompileBudget::admit(fun, time);
     }
 
-    if (fun->isOptimized())
+    if (fun->isOptimized() || pir::Parameter::PIR_ADAPTIVE_WARMUP)
         return false;
     auto wu = pir::Parameter::PIR_WARMUP;
-    if (wu == 0)
-        return !abandon;
-
-    if (fun->invocationCount() == wu)
-        return !abandon;
+    auto count = fun->invocationCount();
+    // Deferred requests are repeated on every call, until they are admitted
+    // or dropped
+    if (wu == 0 || count == wu ||
+        (count > wu && CompileBudget::isPending(fun)))
+        return !abandon && CompileBudget::admit(fun, fun->invocationTime());
 
     return false;
 }
@@ -114,7 +130,16 @@ inline void DoRecompile(Function* fun, SEXP ast, SEXP callee, Context given) {
         name = lhs;
     if (flags.contains(Function::MarkOpt))
         fun->flags.reset(Function::MarkOpt);
+    auto start = Function::rdtsc();
     globalContext()->closureOptimizer(callee, given, name);
+    auto time = Function::rdtsc() - start;
+    // The next versions of the function are expected to take as long
+    auto table = DispatchTable::unpack(BODY(callee));
+    table->baseline()->registerCompileTime(time);
+    auto opt = table->dispatch(given);
+    if (opt != table->baseline())
+        opt->registerCompileTime(time);
+    CompileBudget::charge(time);
 }
 
 inline bool matches(const CallContext& call, Function* f) {
@@ -137,6 +162,11 @@ void deoptFramesWithContext(const CallContext* callCtxt,
                             DeoptMetadata* deoptData, SEXP sysparent,
                             size_t pos, size_t stackHeight,
                             RCNTXT* currentContext);
+// Returns nullptr if some frame cannot be resumed deoptless, before touching
+// any of them.
+SEXP deoptlessInlinedFrames(Code* c, const CallContext& call,
+                            DeoptMetadata* m, const DeoptReason& reason,
+                            SEXP trigger, RCNTXT** outerContext);
 void jit(SEXP cls, SEXP name);
 
 SEXP seq_int(int n1, int n2);
@@ -268,152 +298,39 @@ inline SEXPREC createFakeCONS(SEXP cdr) {
     SLOWASSERT(__a2__cell__.u.listsxp.cdrval == R_NilValue &&                  \
                "broken cons a2/2")
 
-#define FAKE_ARGS3(res, a1, a2, a3)                                            \
-    SEXPREC __a3__cell__;                                                      \
-    createFakeCONS(__a3__cell__, R_NilValue);                                  \
-    SEXPREC __a2__cell__;                                                      \
-    createFakeCONS(__a2__cell__, &__a3__cell__);                               \
-    SEXPREC __a1__cell__;                                                      \
-    createFakeCONS(__a1__cell__, &__a2__cell__);                               \
-    __a1__cell__.u.listsxp.carval = a1;                                        \
-    __a2__cell__.u.listsxp.carval = a2;                                        \
-    __a3__cell__.u.listsxp.carval = a3;                                        \
-    res = &__a1__cell__
-
-#define CHECK_FAKE_ARGS3()                                                     \
-    SLOWASSERT(__a1__cell__.gengc_next_node == R_NilValue &&                   \
-               "broken cons gengc_next_node a1/3");                            \
-    SLOWASSERT(__a2__cell__.gengc_next_node == R_NilValue &&                   \
-               "broken cons gengc_next_node a2/3");                            \
-    SLOWASSERT(__a3__cell__.gengc_next_node == R_NilValue &&                   \
-               "broken cons gengc_next_node a3/3");                            \
-    SLOWASSERT(__a1__cell__.gengc_prev_node == R_NilValue &&                   \
-               "broken cons gengc_prev_node a1/3");                            \
-    SLOWASSERT(__a2__cell__.gengc_prev_node == R_NilValue &&                   \
-               "broken cons gengc_prev_node a2/3");                            \
-    SLOWASSERT(__a3__cell__.gengc_prev_node == R_NilValue &&                   \
-               "broken cons gengc_prev_node a3/3");                            \
-    SLOWASSERT(__a1__cell__.u.listsxp.tagval == R_NilValue &&                  \
-               "broken cons tag a1/3");                                        \
-    SLOWASSERT(__a2__cell__.u.listsxp.tagval == R_NilValue &&                  \
-               "broken cons tag a2/3");                                        \
-    SLOWASSERT(__a3__cell__.u.listsxp.tagval == R_NilValue &&                  \
-               "broken cons tag a3/3");                                        \
-    SLOWASSERT(__a1__cell__.u.listsxp.cdrval == &__a2__cell__ &&               \
-               "broken cons a1/3");                                            \
-    SLOWASSERT(__a2__cell__.u.listsxp.cdrval == &__a3__cell__ &&               \
-               "broken cons a2/3");                                            \
-    SLOWASSERT(__a3__cell__.u.listsxp.cdrval == R_NilValue &&                  \
-               "broken cons a3/3")
-
-#define FAKE_ARGS4(res, a1, a2, a3, a4)                                        \
-    SEXPREC __a4__cell__;                                                      \
-    createFakeCONS(__a4__cell__, R_NilValue);                                  \
-    SEXPREC __a3__cell__;                                                      \
-    createFakeCONS(__a3__cell__, &__a4__cell__);                               \
-    SEXPREC __a2__cell__;                                                      \
-    createFakeCONS(__a2__cell__, &__a3__cell__);                               \
-    SEXPREC __a1__cell__;                                                      \
-    createFakeCONS(__a1__cell__, &__a2__cell__);                               \
-    __a1__cell__.u.listsxp.carval = a1;                                        \
-    __a2__cell__.u.listsxp.carval = a2;                                        \
-    __a3__cell__.u.listsxp.carval = a3;                                        \
-    __a4__cell__.u.listsxp.carval = a4;                                        \
-    res = &__a1__cell__
-
-#define CHECK_FAKE_ARGS4()                                                     \
-    SLOWASSERT(__a1__cell__.gengc_next_node == R_NilValue &&                   \
-               "broken cons gengc_next_node a1/4");                            \
-    SLOWASSERT(__a2__cell__.gengc_next_node == R_NilValue &&                   \
-               "broken cons gengc_next_node a2/4");                            \
-    SLOWASSERT(__a3__cell__.gengc_next_node == R_NilValue &&                   \
-               "broken cons gengc_next_node a3/4");                            \
-    SLOWASSERT(__a4__cell__.gengc_next_node == R_NilValue &&                   \
-               "broken cons gengc_next_node a4/4");                            \
-    SLOWASSERT(__a1__cell__.gengc_prev_node == R_NilValue &&                   \
-               "broken cons gengc_prev_node a1/4");                            \
-    SLOWASSERT(__a2__cell__.gengc_prev_node == R_NilValue &&                   \
-               "broken cons gengc_prev_node a2/4");                            \
-    SLOWASSERT(__a3__cell__.gengc_prev_node == R_NilValue &&                   \
-               "broken cons gengc_prev_node a3/4");                            \
-    SLOWASSERT(__a4__cell__.gengc_prev_node == R_NilValue &&                   \
-               "broken cons gengc_prev_node a4/4");                            \
-    SLOWASSERT(__a1__cell__.u.listsxp.tagval == R_NilValue &&                  \
-               "broken cons tag a1/4");                                        \
-    SLOWASSERT(__a2__cell__.u.listsxp.tagval == R_NilValue &&                  \
-               "broken cons tag a2/4");                                        \
-    SLOWASSERT(__a3__cell__.u.listsxp.tagval == R_NilValue &&                  \
-               "broken cons tag a3/4");                                        \
-    SLOWASSERT(__a4__cell__.u.listsxp.tagval == R_NilValue &&                  \
-               "broken cons tag a4/4");                                        \
-    SLOWASSERT(__a1__cell__.u.listsxp.cdrval == &__a2__cell__ &&               \
-               "broken cons a1/4");                                            \
-    SLOWASSERT(__a2__cell__.u.listsxp.cdrval == &__a3__cell__ &&               \
-               "broken cons a2/4");                                            \
-    SLOWASSERT(__a3__cell__.u.listsxp.cdrval == &__a4__cell__ &&               \
-               "broken cons a3/4");                                            \
-    SLOWASSERT(__a4__cell__.u.listsxp.cdrval == R_NilValue &&                  \
-               "broken cons a4/4")
-
-#define FAKE_ARGS5(res, a1, a2, a3, a4, a5)                                    \
-    SEXPREC __a5__cell__;                                                      \
-    createFakeCONS(__a5__cell__, R_NilValue);                                  \
-    SEXPREC __a4__cell__;                                                      \
-    createFakeCONS(__a4__cell__, &__a5__cell__);                               \
-    SEXPREC __a3__cell__;                                                      \
-    createFakeCONS(__a3__cell__, &__a4__cell__);                               \
-    SEXPREC __a2__cell__;                                                      \
-    createFakeCONS(__a2__cell__, &__a3__cell__);                               \
-    SEXPREC __a1__cell__;                                                      \
-    createFakeCONS(__a1__cell__, &__a2__cell__);                               \
-    __a1__cell__.u.listsxp.carval = a1;                                        \
-    __a2__cell__.u.listsxp.carval = a2;                                        \
-    __a3__cell__.u.listsxp.carval = a3;                                        \
-    __a4__cell__.u.listsxp.carval = a4;                                        \
-    __a5__cell__.u.listsxp.carval = a5;                                        \
-    res = &__a1__cell__
+// Like FAKE_ARGSn for a number of arguments only known at runtime. The cells
+// live wherever the FakeArglist lives (usually the C stack), so they are
+// neither allocated nor seen by the gc. The arguments need to be protected
+// by the caller, the callee must not hold on to the arglist.
+template <size_t N>
+struct FakeArglist {
+    SEXPREC cells[N];
+
+    SEXP init(SEXP* args, size_t n) {
+        assert(n <= N);
+        if (n == 0)
+            return R_NilValue;
+        for (size_t i = 0; i < n; ++i) {
+            createFakeCONS(cells[i], i + 1 < n ? &cells[i + 1] : R_NilValue);
+            cells[i].u.listsxp.carval = args[i];
+        }
+        return &cells[0];
+    }
 
-#define CHECK_FAKE_ARGS5()                                                     \
-    SLOWASSERT(__a1__cell__.gengc_next_node == R_NilValue &&                   \
-               "broken cons gengc_next_node a1/5");                            \
-    SLOWASSERT(__a2__cell__.gengc_next_node == R_NilValue &&                   \
-               "broken cons gengc_next_node a2/5");                            \
-    SLOWASSERT(__a3__cell__.gengc_next_node == R_NilValue &&                   \
-               "broken cons gengc_next_node a3/5");                            \
-    SLOWASSERT(__a4__cell__.gengc_next_node == R_NilValue &&                   \
-               "broken cons gengc_next_node a4/5");                            \
-    SLOWASSERT(__a5__cell__.gengc_next_node == R_NilValue &&                   \
-               "broken cons gengc_next_node a5/5");                            \
-    SLOWASSERT(__a1__cell__.gengc_prev_node == R_NilValue &&                   \
-               "broken cons gengc_prev_node a1/5");                            \
-    SLOWASSERT(__a2__cell__.gengc_prev_node == R_NilValue &&                   \
-               "broken cons gengc_prev_node a2/5");                            \
-    SLOWASSERT(__a3__cell__.gengc_prev_node == R_NilValue &&                   \
-               "broken cons gengc_prev_node a3/5");                            \
-    SLOWASSERT(__a4__cell__.gengc_prev_node == R_NilValue &&                   \
-               "broken cons gengc_prev_node a4/5");                            \
-    SLOWASSERT(__a5__cell__.gengc_prev_node == R_NilValue &&                   \
-               "broken cons gengc_prev_node a5/5");                            \
-    SLOWASSERT(__a1__cell__.u.listsxp.tagval == R_NilValue &&                  \
-               "broken cons tag a1/5");                                        \
-    SLOWASSERT(__a2__cell__.u.listsxp.tagval == R_NilValue &&                  \
-               "broken cons tag a2/5");                                        \
-    SLOWASSERT(__a3__cell__.u.listsxp.tagval == R_NilValue &&                  \
-               "broken cons tag a3/5");                                        \
-    SLOWASSERT(__a4__cell__.u.listsxp.tagval == R_NilValue &&                  \
-               "broken cons tag a4/5");                                        \
-    SLOWASSERT(__a5__cell__.u.listsxp.tagval == R_NilValue &&                  \
-               "broken cons tag a4/5");                                        \
-    SLOWASSERT(__a1__cell__.u.listsxp.cdrval == &__a2__cell__ &&               \
-               "broken cons a1/5");                                            \
-    SLOWASSERT(__a2__cell__.u.listsxp.cdrval == &__a3__cell__ &&               \
-               "broken cons a2/5");                                            \
-    SLOWASSERT(__a3__cell__.u.listsxp.cdrval == &__a4__cell__ &&               \
-               "broken cons a3/5");                                            \
-    SLOWASSERT(__a4__cell__.u.listsxp.cdrval == &__a5__cell__ &&               \
-               "broken cons a4/5");                                            \
-    SLOWASSERT(__a5__cell__.u.listsxp.cdrval == R_NilValue &&                  \
-               "broken cons a5/5")
+    void check(size_t n) const {
+        for (size_t i = 0; i < n; ++i) {
+            SLOWASSERT(cells[i].gengc_next_node == R_NilValue &&
+                       "broken cons gengc_next_node");
+            SLOWASSERT(cells[i].gengc_prev_node == R_NilValue &&
+                       "broken cons gengc_prev_node");
+            SLOWASSERT(cells[i].u.listsxp.tagval == R_NilValue &&
+                       "broken cons tag");
+            SLOWASSERT(cells[i].u.listsxp.cdrval ==
+                           (i + 1 < n ? &cells[i + 1] : R_NilValue) &&
+                       "broken cons");
+        }
+    }
+};
 
 } // namespace rir
 #endif // RIR_INTERPRETER_C_H
@@ -0,0 +1,52 @@
+#include "invocation_sampler.h"
+#include "runtime/Function.h"
+
+#include <signal.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/time.h>
+
+namespace rir {
+
+// Only touched by the handler once the timer runs, which does not nest
+static unsigned long lastSample = 0;
+
+// Runs asynchronously, thus it only advances the clock. The functions read it
+// when they are entered and add the difference when they return.
+static void sample(int) {
+    auto now = Function::rdtsc();
+    Function::sampledTicks.fetch_add(now - lastSample,
+                                     std::memory_order_relaxed);
+    lastSample = now;
+}
+
+void InvocationSampler::initSampler() {
+    auto env = getenv("PIR_SAMPLE_TIMING");
+    auto period = env ? atoi(env) : 0;
+    if (period <= 0)
+        return;
+
+    struct sigaction sa;
+    memset(&sa, 0, sizeof(struct sigaction));
+    sa.sa_handler = sample;
+    sa.sa_flags = SA_RESTART;
+    if (sigaction(SIGVTALRM, &sa, nullptr) < 0) {
+        perror("sigaction");
+        return;
+    }
+
+    // Counts the CPU time of the process, unlike ITIMER_PROF it is not used
+    // by Rprof
+    struct itimerval timer;
+    timer.it_interval.tv_sec = period / 1000000;
+    timer.it_interval.tv_usec = period % 1000000;
+    timer.it_value = timer.it_interval;
+    lastSample = Function::rdtsc();
+    if (setitimer(ITIMER_VIRTUAL, &timer, nullptr) < 0) {
+        perror("setitimer");
+        return;
+    }
+    Function::sampledInvocationTime = true;
+}
+
+} // namespace rir
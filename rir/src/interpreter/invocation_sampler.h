@@ -0,0 +1,20 @@
+#ifndef interpreter_invocation_sampler_h
+#define interpreter_invocation_sampler_h
+
+namespace rir {
+
+/*
+ * Measures the invocation time of functions by sampling, instead of reading
+ * the timestamp counter on every call. A timer periodically advances a clock
+ * by the ticks since the last sample, and functions are charged the time the
+ * clock advanced between their entry and return, see Function::clock. Enabled
+ * by PIR_SAMPLE_TIMING=<period in microseconds>.
+ */
+class InvocationSampler {
+  public:
+    static void initSampler();
+};
+
+} // namespace rir
+
+#endif
@@ -1,5 +1,6 @@
 #include "api.h"
 #include "interp.h"
+#include "invocation_sampler.h"
 #include "profiler.h"
 
 #include <iomanip>
@@ -31,6 +32,7 @@ void initializeRuntime() {
                          rirDecompile, rirPrint, deserializeRir, serializeRir,
                          materialize);
     RuntimeProfiler::initProfiler();
+    InvocationSampler::initSampler();
 }
 
 InterpreterInstance* globalContext() { return globalContext_; }
@@ -3,6 +3,7 @@
 #include "R/Printing.h"
 #include "R/Serialize.h"
 #include "bc/BC.h"
+#include "bc/Compiler.h"
 #include "compiler/native/pir_jit_llvm.h"
 #include "utils/Pool.h"
 
@@ -58,6 +59,15 @@ Code::~Code() {
 
 void Code::function(Function* fun) { setEntry(3, fun->container()); }
 
+Code* Code::getPromise(size_t idx) const {
+    if (isLazyPromise(idx)) {
+        auto prom =
+            Compiler::compileLazyPromise(getExtraPoolEntry(idx), function());
+        SET_VECTOR_ELT(getEntry(0), idx, prom->container());
+    }
+    return unpack(getExtraPoolEntry(idx));
+}
+
 rir::Function* Code::function() const {
     auto f = getEntry(3);
     assert(f);
@@ -265,8 +275,13 @@ void Code::disassemble(std::ostream& out, const std::string& prefix) const {
         }
 
         for (auto i : promises) {
-            auto c = getPromise(i);
             out << "\n[Prom (index " << prefix << i << ")]\n";
+            if (isLazyPromise(i)) {
+                out << "not compiled yet: "
+                    << Print::dumpSexp(getExtraPoolEntry(i)) << "\n";
+                continue;
+            }
+            auto c = getPromise(i);
             std::stringstream ss;
             ss << prefix << i << ".";
             c->disassemble(out, ss.str());
@@ -181,8 +181,10 @@ struct Code : public RirRuntimeObject<Code, CODE_MAGIC> {
         return VECTOR_ELT(getEntry(0), i);
     }
 
-    Code* getPromise(size_t idx) const {
-        return unpack(getExtraPoolEntry(idx));
+    // Promises start out as their AST and are compiled on first use
+    Code* getPromise(size_t idx) const;
+    bool isLazyPromise(size_t idx) const {
+        return !check(getExtraPoolEntry(idx));
     }
 
     PirTypeFeedback* pirTypeFeedback() const {
@@ -1,9 +1,14 @@
 #include "Function.h"
 #include "R/Serialize.h"
+#include "bc/Compiler.h"
 #include "compiler/compiler.h"
+#include "compiler/parameter.h"
 
 namespace rir {
 
+bool Function::sampledInvocationTime = false;
+std::atomic<unsigned long> Function::sampledTicks(0);
+
 Function* Function::deserialize(SEXP refTable, R_inpstream_t inp) {
     size_t functionSize = InInteger(inp);
     const FunctionSignature sig = FunctionSignature::deserialize(refTable, inp);
@@ -52,6 +57,17 @@ void Function::serialize(SEXP refTable, R_outpstream_t out) const {
     OutInteger(out, flags.to_i());
 }
 
+unsigned long Function::compileCost() const {
+    if (compileTime)
+        return compileTime;
+    return (unsigned long)body()->codeSize * pir::Parameter::PIR_COMPILE_COST;
+}
+
+void Function::compileDefaultArg(size_t i) {
+    auto arg = Compiler::compileLazyPromise(defaultArg_[i], this);
+    setEntry(NUM_PTRS + i, arg->container());
+}
+
 void Function::disassemble(std::ostream& out) {
     out << "[sigature] ";
     signature().print(out);
@@ -68,6 +84,7 @@ void Function::disassemble(std::ostream& out) {
     out << "[stats]    ";
     out << "invoked: " << invocationCount()
         << ", time: " << ((double)invocationTime() / 1e6)
+        << "ms, compile: " << ((double)compileCost() / 1e6)
         << "ms, deopt: " << deoptCount();
     out << "\n";
     body()->disassemble(out);
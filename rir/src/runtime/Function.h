@@ -6,6 +6,8 @@
 #include "R/r.h"
 #include "RirRuntimeObject.h"
 
+#include <atomic>
+
 namespace rir {
 
 /**
@@ -67,12 +69,19 @@ struct Function : public RirRuntimeObject<Function, FUNCTION_MAGIC> {
                FunctionSignature::OptimizationLevel::Baseline;
     }
 
+    // Default arguments start out as their AST and are compiled on first use
     Code* defaultArg(size_t i) const {
         assert(i < numArgs_);
         if (!defaultArg_[i])
             return nullptr;
+        if (isLazyDefaultArg(i))
+            const_cast<Function*>(this)->compileDefaultArg(i);
         return Code::unpack(defaultArg_[i]);
     }
+    bool isLazyDefaultArg(size_t i) const {
+        assert(i < numArgs_);
+        return defaultArg_[i] && !Code::check(defaultArg_[i]);
+    }
 
     size_t invocationCount() { return invocationCount_; }
 
@@ -86,6 +95,17 @@ struct Function : public RirRuntimeObject<Function, FUNCTION_MAGIC> {
     }
     static constexpr unsigned long MAX_TIME_MEASURE = 1e9;
 
+    // The invocation time is read from the clock of the InvocationSampler,
+    // which only advances when a sample is taken, instead of the timestamp
+    // counter
+    static bool sampledInvocationTime;
+    static std::atomic<unsigned long> sampledTicks;
+    static unsigned long clock() {
+        if (sampledInvocationTime)
+            return sampledTicks.load(std::memory_order_relaxed) + 1;
+        return rdtsc();
+    }
+
     void unregisterInvocation() {
         invoked = 0;
         if (invocationCount_ > 0)
@@ -94,11 +114,14 @@ struct Function : public RirRuntimeObject<Function, FUNCTION_MAGIC> {
 
     void registerInvocation() {
         if (execTime < MAX_TIME_MEASURE) {
-            // constant increment for recursive functions
-            if (invoked != 0)
-                execTime += 5e5;
-            else
-                invoked = rdtsc();
+            // constant increment for recursive functions, the sampled time of
+            // the outermost call already covers them
+            if (invoked != 0) {
+                if (!sampledInvocationTime)
+                    execTime += 5e5;
+            } else {
+                invoked = clock();
+            }
         }
 
         if (invocationCount_ < UINT_MAX)
@@ -106,13 +129,18 @@ struct Function : public RirRuntimeObject<Function, FUNCTION_MAGIC> {
     }
     void registerEndInvocation() {
         if (invoked != 0) {
-            execTime += rdtsc() - invoked;
+            execTime += clock() - invoked;
             invoked = 0;
         }
     }
     unsigned long invocationTime() { return execTime; }
     void clearInvocationTime() { execTime = 0; }
 
+    // Cost of optimizing this function in ticks. The time its last
+    // optimization took, or an estimate based on the size of the bytecode.
+    unsigned long compileCost() const;
+    void registerCompileTime(unsigned long time) { compileTime = time; }
+
     unsigned size; /// Size, in bytes, of the function and its data
 
 #define RIR_FUNCTION_FLAGS(V)                                                  \
@@ -128,7 +156,8 @@ struct Function : public RirRuntimeObject<Function, FUNCTION_MAGIC> {
     V(DisableArgumentTypeSpecialization)                                       \
     V(NeedsFullEnv)                                                            \
     V(Reoptimize)                                                              \
-    V(DisableNumArgumentsSpezialization)
+    V(DisableNumArgumentsSpezialization)                                       \
+    V(FeedbackFrozen)
 
     enum Flag {
 #define V(F) F,
@@ -136,7 +165,7 @@ struct Function : public RirRuntimeObject<Function, FUNCTION_MAGIC> {
 #undef V
 
         FIRST = Deopt,
-        LAST = DisableNumArgumentsSpezialization
+        LAST = FeedbackFrozen
     };
     EnumSet<Flag> flags;
 
@@ -179,14 +208,26 @@ struct Function : public RirRuntimeObject<Function, FUNCTION_MAGIC> {
             deadCallReached_++;
         if (r == DeoptReason::EnvStubMaterialized)
             flags.set(NeedsFullEnv);
+        unfreezeFeedback();
     }
 
+    // The baseline stops recording type feedback while one of its optimized
+    // versions runs without deopts. Deopts turn recording back on.
+    bool feedbackFrozen() const { return flags.contains(FeedbackFrozen); }
+    void freezeFeedback() {
+        assert(!isOptimized());
+        flags.set(FeedbackFrozen);
+    }
+    void unfreezeFeedback() { flags.reset(FeedbackFrozen); }
+
     size_t deadCallReached() const {
         assert(!isOptimized());
         return deadCallReached_;
     }
 
   private:
+    void compileDefaultArg(size_t i);
+
     unsigned numArgs_;
 
     unsigned invocationCount_ = 0;
@@ -196,6 +237,7 @@ struct Function : public RirRuntimeObject<Function, FUNCTION_MAGIC> {
 
     unsigned long invoked = 0;
     unsigned long execTime = 0;
+    unsigned long compileTime = 0;
 
     FunctionSignature signature_; /// pointer to this version's signature
     Context context_;
@@ -44,11 +44,17 @@ inline bool fastVeceltOk(SEXP vec) {
 }
 
 struct ObservedTest {
+    static constexpr unsigned CounterBits = 15;
+    static constexpr unsigned CounterOverflow = (1 << CounterBits) - 1;
+
     enum { None, OnlyTrue, OnlyFalse, Both };
     uint32_t seen : 2;
-    uint32_t unused : 30;
+    // Approximate frequencies of the outcomes. When one of them overflows
+    // both are halved, which keeps their ratio.
+    uint32_t trueCount : CounterBits;
+    uint32_t falseCount : CounterBits;
 
-    ObservedTest() : seen(0), unused(0) {}
+    ObservedTest() : seen(0), trueCount(0), falseCount(0) {}
 
     inline void record(SEXP e) {
         if (e == R_TrueValue) {
@@ -56,6 +62,7 @@ struct ObservedTest {
                 seen = OnlyTrue;
             else if (seen != OnlyTrue)
                 seen = Both;
+            count(true);
             return;
         }
         if (e == R_FalseValue) {
@@ -63,10 +70,23 @@ struct ObservedTest {
                 seen = OnlyFalse;
             else if (seen != OnlyFalse)
                 seen = Both;
+            count(false);
             return;
         }
         seen = Both;
     }
+
+  private:
+    inline void count(bool outcome) {
+        if (trueCount == CounterOverflow || falseCount == CounterOverflow) {
+            trueCount >>= 1;
+            falseCount >>= 1;
+        }
+        if (outcome)
+            trueCount++;
+        else
+            falseCount++;
+    }
 };
 static_assert(sizeof(ObservedTest) == sizeof(uint32_t),
               "Size needs to fit inside a record_ bc immediate args");
@@ -97,6 +117,13 @@ struct ObservedValues {
 
     void reset() { *this = ObservedValues(); }
 
+    // Nothing recorded from now on can change this slot (stateBeforeLastForce
+    // is not updated by record)
+    bool saturated() const {
+        return numTypes == MaxTypes && notScalar && object && attribs &&
+               notFastVecelt;
+    }
+
     void print(std::ostream& out) const {
         if (numTypes) {
             for (size_t i = 0; i < numTypes; ++i) {
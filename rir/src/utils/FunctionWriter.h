@@ -39,6 +39,11 @@ class FunctionWriter {
         defaultArgs.push_back(code->container());
     }
 
+    void addLazyDefaultArg(SEXP ast) {
+        assert(!Code::check(ast));
+        defaultArgs.push_back(ast);
+    }
+
     void finalize(Code* body, const FunctionSignature& signature,
                   const Context& context) {
         assert(function_ == nullptr && "Trying to finalize a second time");
@@ -59,6 +64,14 @@ class FunctionWriter {
         function_ = fun;
     }
 
+    // Adds the code written so far to an existing function, instead of
+    // finalizing a new one
+    void attach(Function* fun) {
+        assert(function_ == nullptr && "Trying to attach a finalized writer");
+        for (auto& c : codes)
+            c->function(fun);
+    }
+
     Code* writeCode(SEXP ast, void* bc, unsigned originalCodeSize,
                     const std::map<PcOffset, BC::PoolIdx>& sources,
                     const std::map<PcOffset, BC::Label>& patchpoints,
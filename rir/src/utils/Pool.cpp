@@ -1,5 +1,6 @@
 #include "utils/Pool.h"
 #include "R/Protect.h"
+#include "runtime/Code.h"
 
 namespace rir {
 
@@ -7,6 +8,34 @@ std::unordered_map<double, unsigned> Pool::numbers;
 std::unordered_map<int, unsigned> Pool::ints;
 std::unordered_map<SEXP, size_t> Pool::contents;
 std::unordered_set<size_t> Pool::patchable;
+std::vector<size_t> Pool::freeSlots;
+size_t Pool::owned = 0;
+
+// The owner holds a token in its extra pool, which frees the slot when it is
+// finalized. The token is an external pointer, since R only finalizes those
+// and environments.
+void Pool::own(size_t idx, Code* owner) {
+    SEXP token = R_MakeExternalPtr((void*)(uintptr_t)idx, R_NilValue,
+                                   R_NilValue);
+    Protect p(token);
+    R_RegisterCFinalizerEx(token, release, FALSE);
+    owner->addExtraPoolEntry(token);
+    owned++;
+}
+
+void Pool::release(SEXP token) {
+    auto idx = (size_t)(uintptr_t)R_ExternalPtrAddr(token);
+    R_ClearExternalPtr(token);
+    cp_pool_set(idx, R_NilValue);
+    patchable.erase(idx);
+    freeSlots.push_back(idx);
+    owned--;
+}
+
+Pool::Stats Pool::stats() {
+    return {cp_pool_length(), freeSlots.size(),
+            numbers.size() + ints.size() + contents.size(), owned};
+}
 
 BC::PoolIdx Pool::getNum(double n) {
     if (numbers.count(n))
@@ -18,7 +47,7 @@ BC::PoolIdx Pool::getNum(double n) {
     REAL(s)[0] = n;
     SET_NAMED(s, 2);
 
-    size_t i = cp_pool_add(s);
+    size_t i = add(s);
     assert(i < BC::MAX_POOL_IDX);
 
     numbers[n] = i;
@@ -35,7 +64,7 @@ BC::PoolIdx Pool::getInt(int n) {
     INTEGER(s)[0] = n;
     SET_NAMED(s, 2);
 
-    size_t i = cp_pool_add(s);
+    size_t i = add(s);
     assert(i < BC::MAX_POOL_IDX);
 
     ints[n] = i;
@@ -8,14 +8,37 @@
 
 #include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 namespace rir {
 
+struct Code;
+
+/** The global constant pool.
+ *
+ * Most entries are interned and live forever. Entries which belong to a
+ * single code object (see makeSpace and insertOwned with an owner) are freed
+ * once their owner is garbage collected and the slot is reused.
+ */
 class Pool {
     static std::unordered_map<double, BC::PoolIdx> numbers;
     static std::unordered_map<int, BC::PoolIdx> ints;
     static std::unordered_map<SEXP, size_t> contents;
     static std::unordered_set<size_t> patchable;
+    static std::vector<size_t> freeSlots;
+    static size_t owned;
+
+    static size_t add(SEXP e) {
+        if (freeSlots.empty())
+            return cp_pool_add(e);
+        auto i = freeSlots.back();
+        freeSlots.pop_back();
+        cp_pool_set(i, e);
+        return i;
+    }
+
+    static void own(size_t idx, Code* owner);
+    static void release(SEXP token);
 
   public:
     static BC::PoolIdx insert(SEXP e) {
@@ -23,17 +46,43 @@ class Pool {
             return contents.at(e);
 
         SET_NAMED(e, 2);
-        size_t i = cp_pool_add(e);
+        size_t i = add(e);
         contents[e] = i;
         return i;
     }
 
+    // Looks up the slot of an interned constant
+    static bool interned(SEXP e, BC::PoolIdx& idx) {
+        auto i = contents.find(e);
+        if (i == contents.end())
+            return false;
+        idx = i->second;
+        return true;
+    }
+
+    // A slot which is not shared with anyone else and is freed together with
+    // owner.
+    static BC::PoolIdx insertOwned(SEXP e, Code* owner) {
+        SET_NAMED(e, 2);
+        size_t i = add(e);
+        own(i, owner);
+        return i;
+    }
+
     static BC::PoolIdx makeSpace() {
-        size_t i = cp_pool_add(R_NilValue);
+        size_t i = add(R_NilValue);
         patchable.insert(i);
         return i;
     }
 
+    static BC::PoolIdx makeSpace(Code* owner) {
+        auto i = makeSpace();
+        own(i, owner);
+        return i;
+    }
+
+    static bool isPatchable(BC::PoolIdx idx) { return patchable.count(idx); }
+
     static void patch(BC::PoolIdx idx, SEXP e) {
         // Patching must not write to contents, otherwise nasty bugs can occur!
         // Eg.: we makeSpace 42, patch X into 42, then patch Y into 42, X gets
@@ -52,6 +101,14 @@ class Pool {
     static BC::PoolIdx getInt(int n);
 
     static SEXP get(BC::PoolIdx i) { return cp_pool_at(i); }
+
+    struct Stats {
+        size_t size;
+        size_t free;
+        size_t interned;
+        size_t owned;
+    };
+    static Stats stats();
 };
 
 } // namespace rir
@@ -0,0 +1,32 @@
+# With PIR_ADAPTIVE_WARMUP=1, functions are optimized once the time spent in
+# them outweighs their estimated compile time. The time is measured, so only
+# check that hot functions get optimized and keep computing the right results.
+if (Sys.getenv("PIR_ENABLE") != "" || Sys.getenv("PIR_ADAPTIVE_WARMUP") != "1")
+  quit()
+
+callsUntilOptimized <- function(f) {
+  for (i in 1:5000) {
+    stopifnot(f(1) == 45150)
+    if (length(rir.functionVersions(f)) > 1)
+      return(i)
+  }
+  Inf
+}
+
+cheap <- rir.compile(function(x) {
+  s <- 0
+  for (i in 1:300) s <- s + i * x
+  s
+})
+stopifnot(is.finite(callsUntilOptimized(cheap)))
+
+# The same work, plus a large branch which is never taken
+dead <- as.call(c(as.name("{"), rep(list(quote(x <- x * 2 + 1)), 500)))
+expensive <- rir.compile(eval(bquote(function(x) {
+  if (x < 0) .(dead)
+  s <- 0
+  for (i in 1:300) s <- s + i * x
+  s
+})))
+callsUntilOptimized(expensive)
+stopifnot(expensive(1) == 45150, expensive(-1) == 45150 * -1)
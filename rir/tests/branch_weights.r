@@ -0,0 +1,46 @@
+# record_test_ counts how often a test was TRUE and FALSE. The counts become
+# branch weights in native code, which must not change the results.
+
+f <- function(n) {
+  s <- 0
+  i <- 0
+  while (i < n) {
+    i <- i + 1
+    s <- s + i
+  }
+  s
+}
+for (i in 1:20)
+  stopifnot(f(i) == i * (i + 1) / 2)
+d <- rir.disassemble(f, asText = TRUE)
+stopifnot(any(grepl("^ *[0-9]* +\\[ \\? [0-9]+:[0-9]+ \\]$", d)))
+pir.compile(f)
+stopifnot(f(100) == 5050)
+stopifnot(f(0) == 0)
+
+# Rarely taken branches
+g <- function(x) {
+  r <- 0
+  for (i in x)
+    while (i > 99) {
+      r <- r + 1
+      i <- 0
+    }
+  r
+}
+for (i in 1:20)
+  stopifnot(g(1:100) == 1)
+pir.compile(g)
+stopifnot(g(1:100) == 1)
+stopifnot(g(100:200) == 101)
+
+# The condition of an if is recorded too, ahead of the fused branch
+h <- function(x) if (x %% 2 == 0) "even" else "odd"
+for (i in 1:20)
+  stopifnot(h(i) == c("odd", "even")[[i %% 2 + 1]])
+d <- rir.disassemble(h, asText = TRUE)
+stopifnot(any(grepl("^ *[0-9]* +\\[ \\? [0-9]+:[0-9]+ \\]$", d)))
+stopifnot(any(grepl("asbool_brtrue_", d)))
+pir.compile(h)
+stopifnot(h(1) == "odd")
+stopifnot(h(2) == "even")
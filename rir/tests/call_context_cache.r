@@ -0,0 +1,25 @@
+# call_ sites memoize the inferred context. The same call site sees different
+# argument kinds and callees here, none of them may be dispatched to a version
+# compiled for another context. The arguments of fun are lazy promises which
+# only look up x and y, they are part of the memo key too.
+
+f <- function(a, b) a + b
+g <- function(a, b = 10L) a * b
+h <- function(...) length(list(...))
+
+site <- function(fun, x, y) fun(x, y)
+site2 <- function(fun, x) fun(x)
+
+for (i in 1:50) {
+  stopifnot(site(f, 1, 2) == 3)
+  stopifnot(identical(site(f, 1L, 2L), 3L))
+  stopifnot(identical(site(g, 2L, 3L), 6L))
+  stopifnot(site(h, 1, "a") == 2)
+  stopifnot(identical(site(f, c(1, 2), 1), c(2, 3)))
+  x <- structure(1, class = "foo")
+  stopifnot(inherits(site(f, x, 1), "foo"))
+  stopifnot(identical(site2(g, 3L), 30L))
+  stopifnot(site(f, i, i) == 2 * i)
+  v <- if (i %% 3 == 0) i else if (i %% 3 == 1) i + 0.5 else x
+  stopifnot(identical(unclass(site(f, v, 1L)), unclass(v) + 1L))
+}
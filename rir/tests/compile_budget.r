@@ -0,0 +1,53 @@
+# Optimizations beyond the compile budget are deferred. Whether they are or
+# not, hot functions have to keep computing the right results.
+
+stats <- rir.compileBudgetStats()
+stopifnot(identical(names(stats),
+                    c("admitted", "deferred", "dropped", "pending")))
+stopifnot(all(stats >= 0))
+
+fs <- lapply(1:30, function(k) {
+  force(k)
+  function(n) {
+    s <- 0
+    for (i in 1:n)
+      s <- s + i * k
+    s
+  }
+})
+for (rep in 1:20)
+  for (k in seq_along(fs))
+    stopifnot(fs[[k]](100) == 5050 * k)
+
+after <- rir.compileBudgetStats()
+stopifnot(all(after[c("admitted", "deferred", "dropped")] >=
+              stats[c("admitted", "deferred", "dropped")]))
+stopifnot(after[["pending"]] <= 64)
+
+# With a budget of a single tick, the first request of a window is admitted
+# and the ones after it are deferred. Repeating a deferred request in a later
+# window has to optimize the function eventually.
+if (Sys.getenv("PIR_ENABLE") == "") {
+  old <- rir.setCompileBudget(1)
+  hot <- function() rir.compile(function(n) {
+    s <- 0
+    for (i in 1:n)
+      s <- s + i
+    s
+  })
+  first <- hot()
+  second <- hot()
+  before <- rir.compileBudgetStats()
+  for (i in 1:100) {
+    stopifnot(first(100) == 5050)
+    stopifnot(second(100) == 5050)
+  }
+  stopifnot(rir.compileBudgetStats()[["deferred"]] > before[["deferred"]])
+
+  start <- Sys.time()
+  while (length(rir.functionVersions(second)) == 1 &&
+         Sys.time() - start < 30)
+    stopifnot(second(100) == 5050)
+  stopifnot(length(rir.functionVersions(second)) > 1)
+  rir.setCompileBudget(old)
+}
@@ -0,0 +1,34 @@
+# All deopt exits of a native function share one call of the deopt builtin,
+# each exit pushes its own frame first. Trigger different exits of the same
+# function and check the frames are resumed correctly.
+
+f <- function(a, b, n) {
+  s <- 0L
+  for (i in 1:n) {
+    x <- a + i
+    y <- b * x
+    s <- s + y
+  }
+  s
+}
+
+for (i in 1:20)
+  stopifnot(identical(f(1L, 2L, 10L), 130L))
+
+# Deopt at the first and at the second typed operation
+stopifnot(identical(f(1.5, 2L, 10L), 140))
+stopifnot(identical(f(1L, 2L, 10L), 130L))
+stopifnot(identical(f(1L, 0.5, 10L), 32.5))
+stopifnot(identical(f(1L, 2L, 10L), 130L))
+
+# Branches which were never observed to go one way
+g <- function(x) {
+  if (x > 0)
+    x * 2
+  else
+    -x + length(list(x, x))
+}
+for (i in 1:100)
+  stopifnot(g(i) == 2 * i)
+stopifnot(g(-3) == 5)
+stopifnot(g(4) == 8)
@@ -0,0 +1,43 @@
+# A type surprise inside inlined code. With PIR_DEOPTLESS=1 every inlined
+# frame is resumed by its own continuation, the result has to match the
+# interpreter in any case.
+
+q <- 1L
+helper <- function(a) {
+  b <- a + q
+  b * 2L
+}
+f <- function(n) {
+  s <- 0L
+  for (i in 1:n)
+    s <- s + helper(i)
+  s
+}
+
+for (i in 1:20)
+  stopifnot(identical(f(100L), 10300L))
+
+q <- 0.5
+stopifnot(identical(f(100L), 10200))
+q <- 1L
+stopifnot(identical(f(100L), 10300L))
+
+# Nested inlining with an on.exit in the middle frame
+inner <- function(x) x + q
+middle <- function(x) {
+  on.exit(cnt <<- cnt + 1L)
+  inner(x) * 2
+}
+g <- function(n) {
+  s <- 0
+  for (i in 1:n)
+    s <- s + middle(i)
+  s
+}
+cnt <- 0L
+for (i in 1:20)
+  stopifnot(g(10L) == 130)
+q <- 2.5
+cnt <- 0L
+stopifnot(g(10L) == 160)
+stopifnot(cnt == 10L)
@@ -0,0 +1,39 @@
+# Builtins called from the interpreter take their arguments from the stack.
+# Check that they agree with GNU R, with and without attributes and objects.
+
+f <- function(x) list(is.null(x), is.integer(x), is.double(x),
+                      is.complex(x), is.character(x), is.environment(x),
+                      is.list(x), is.pairlist(x), is.raw(x), oldClass(x),
+                      names(x), length(x))
+vals <- list(NULL, 1L, 2.5, 1i, "a", globalenv(), list(1, 2), pairlist(a = 1),
+             as.raw(1), c(a = 1, b = 2), structure(1:3, class = "foo"),
+             array(1:2, dim = 2, dimnames = list(c("x", "y"))),
+             factor(c("a", "b")), data.frame(a = 1:2))
+for (i in 1:3)
+  for (v in vals)
+    stopifnot(identical(f(v), eval(body(f), list(x = v), baseenv())))
+
+length.myclass <- function(x) 42L
+names.myclass <- function(x) "dispatched"
+x <- structure(list(1), class = "myclass")
+g <- function(x) c(length(x), names(x))
+stopifnot(identical(g(x), c("42", "dispatched")))
+
+# S4 objects are left to GNU R
+setClass("FastBuiltinsS4", contains = "numeric")
+x <- new("FastBuiltinsS4", 1)
+g <- function(x) oldClass(x)
+for (i in 1:3)
+  stopifnot(identical(g(x), eval(body(g), list(x = x), baseenv())))
+
+# More than five arguments through the fake arglist
+h <- function(a, b) max(a, b, 3, 4, 5, 6, 7)
+stopifnot(h(1, 8) == 8)
+h <- function(a) c(a, "b", "c", "d", "e", "f", "g")
+stopifnot(identical(h("a"), c("a", "b", "c", "d", "e", "f", "g")))
+
+# Attributes which are not objects
+h <- function(a) abs(a)
+stopifnot(identical(h(c(x = -1, y = 2)), c(x = 1, y = 2)))
+h <- function(a, b) rep_len(a, b)
+stopifnot(identical(h(c(x = 1, y = 2), 3L), c(1, 2, 1)))
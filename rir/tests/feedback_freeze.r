@@ -0,0 +1,24 @@
+# The baseline stops recording type feedback while an optimized version is
+# stable. A deopt has to turn recording back on, otherwise the function would
+# be recompiled with the same failing assumptions over and over.
+
+f <- function(x) {
+  if (x > 0)
+    x + 1L
+  else
+    x - 1L
+}
+for (i in 1:1000)
+  stopifnot(f(i) == i + 1L)
+
+for (i in 1:100) {
+  stopifnot(f(-i) == -i - 1L)
+  stopifnot(f(i + 0.5) == i + 1.5)
+  stopifnot(f(i) == i + 1L)
+}
+
+g <- function(h, x) h(x)
+for (i in 1:1000)
+  stopifnot(g(function(x) x, i) == i)
+for (i in 1:100)
+  stopifnot(g(function(x) -x, i) == -i)
@@ -0,0 +1,54 @@
+# Promises and default arguments are only compiled to bytecode when they are
+# first used. Check that they behave as if compiled eagerly.
+
+f <- function(x, y = x * 2, z = stop("unused")) {
+  if (x > 0)
+    identity(y + 1)
+  else
+    identity(list(x, y))
+}
+stopifnot(f(1) == 3)
+stopifnot(f(1, 5) == 6)
+stopifnot(identical(f(-1), list(-1, -2)))
+for (i in 1:20)
+  stopifnot(f(i) == 2 * i + 1)
+
+# Promise expressions are still available
+g <- function(a) substitute(a)
+f <- function(x) g(x + 1)
+stopifnot(identical(f(1), quote(x + 1)))
+f <- function(x = a + b) substitute(x)
+stopifnot(identical(f(), quote(a + b)))
+
+# Nested promises, which are compiled lazily themselves
+f <- function(x) identity(identity(x + 1) * 2)
+for (i in 1:20)
+  stopifnot(f(i) == (i + 1) * 2)
+
+# Bare symbols are compiled eagerly into a lazily compiled promise, their
+# code has to belong to the function as well
+f <- function(x) identity(identity(x))
+g <- function(x) nchar(paste(x))
+h <- function(x, y = identity(x)) y
+for (i in 1:20) {
+  stopifnot(f(i) == i)
+  stopifnot(g("abc") == 3)
+  stopifnot(h(i) == i)
+}
+
+# Promises which break out of a loop are compiled with their surroundings
+f <- function() {
+  i <- 0
+  repeat {
+    i <- i + 1
+    identity(if (i > 3) break)
+  }
+  i
+}
+stopifnot(f() == 4)
+
+# Functions with uncompiled promises survive serialization
+f <- function(x) if (x) identity(1 + 1) else identity(2 + 2)
+f <- rir.compile(f)
+h <- unserialize(serialize(f, NULL))
+stopifnot(h(TRUE) == 2 && h(FALSE) == 4)
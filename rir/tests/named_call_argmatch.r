@@ -0,0 +1,21 @@
+# Argument matching of named calls is memoized per call site. Check it stays
+# correct when the same site sees callees with different formals.
+
+f <- function(x, na.rm = FALSE, scale = 1) if (na.rm) sum(x[!is.na(x)]) * scale else sum(x) * scale
+g <- function(scale, x, na.rm) c(scale, x, na.rm)
+h <- function(x, ...) list(...)$na.rm
+k <- function(x, na.rm.extra = 7) na.rm.extra
+
+site <- function(fun, v) fun(v, na.rm = TRUE)
+site2 <- function(fun, v) fun(scale = 2, v, na.rm = FALSE)
+
+v <- c(1, NA, 3)
+for (i in 1:50) {
+  stopifnot(site(f, v) == 4)
+  stopifnot(identical(site(h, v), TRUE))
+  stopifnot(is.na(site2(f, v)))
+  stopifnot(identical(site2(g, 5), c(2, 5, 0)))
+  stopifnot(site2(f, c(1, 2)) == 6)
+  # partial matching still goes through the full matcher
+  stopifnot(identical(tryCatch(site(k, v), error = function(e) "err"), TRUE))
+}
@@ -0,0 +1,23 @@
+# Native code of functions which are no longer reachable is freed when the
+# next module is compiled. Functions still alive must keep working.
+
+keep <- pir.compile(rir.compile(function(x) x * 3))
+stopifnot(keep(2) == 6)
+
+for (i in 1:30) {
+  f <- rir.compile(function(x) x + 1)
+  f <- pir.compile(f)
+  stopifnot(f(i) == i + 1)
+  if (i %% 5 == 0)
+    invisible(gc())
+}
+before <- pir.nativeModuleCount()
+rm(f)
+invisible(gc())
+invisible(gc())
+
+# Adding the next module frees the unreachable ones
+g <- pir.compile(rir.compile(function(x) keep(x) + 1))
+stopifnot(g(2) == 7)
+stopifnot(pir.nativeModuleCount() < before)
+stopifnot(keep(3) == 9)
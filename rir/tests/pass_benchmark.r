@@ -0,0 +1,20 @@
+# pir.benchmarkPasses times the PIR passes on a list of closures
+
+f <- function(n) {
+  s <- 0
+  for (i in 1:n)
+    s <- s + i
+  s
+}
+g <- function(x) if (x > 0) f(x) else 0
+for (i in 1:5)
+  g(10)
+
+res <- pir.benchmarkPasses(list(f, g, 42))
+stopifnot(is.data.frame(res))
+stopifnot(res$pass[[1]] == "Rir2Pir")
+stopifnot(res$pipelineRuns[[1]] == 2)
+stopifnot(res$isolatedRuns[[1]] == 2)
+stopifnot(nrow(res) > 1)
+stopifnot(all(res$pipelineTime >= 0 & res$isolatedTime >= 0))
+stopifnot(all(res$isolatedRuns <= 2))
@@ -0,0 +1,51 @@
+# Performance checks of pir.check and pir.checkRuntime
+
+sumTo <- function(n) {
+  s <- 0L
+  for (i in 1:n)
+    s <- s + i
+  s
+}
+warmup <- function(f) f(1000L)
+stopifnot(pir.check(sumTo, NoBoxInLoop, NoAllocInLoop, NoDeoptInLoop,
+                    NoExternalCallsInLoop, warmup=warmup))
+
+f <- function(x) {
+  for (i in seq_along(x))
+    print(x[[i]])
+}
+stopifnot(!pir.check(f, NoExternalCallsInLoop))
+stopifnot(!pir.check(f, NoAllocInLoop))
+g <- function(a) a
+f <- function(n) {
+  l <- 0
+  for (i in 1:n)
+    l <- l + g(i)
+  l
+}
+stopifnot(pir.check(f, NativeCallsOnly, warmup=function(f) f(10)))
+f <- function(n) {
+  l <- list()
+  for (i in 1:n)
+    l[[i]] <- c(i, i)
+  l
+}
+stopifnot(!pir.check(f, NoBoxInLoop, warmup=function(f) f(10)))
+stopifnot(pir.check(function() 1, NoAllocInLoop, NoDeoptInLoop))
+
+# The runtime variant
+stopifnot(pir.checkRuntime(sumTo, 100000L, maxAlloc=1000, warmup=warmup))
+f <- function(n) {
+  l <- list()
+  for (i in 1:n)
+    l[[i]] <- c(i, i)
+  l
+}
+stopifnot(!pir.checkRuntime(f, 10000L, maxAlloc=1000))
+h <- rir.compile(function(x) x + 1L)
+for (i in 1:20)
+  h(1L)
+pir.compile(h)
+stopifnot(pir.checkRuntime(h, 1L))
+stopifnot(!pir.checkRuntime(h, 1.5))
+stopifnot(pir.checkRuntime(h, 1.5, maxDeopts=1))
@@ -0,0 +1,39 @@
+# Inlined callees keep their call context, also when it is only linked
+# without setjmp support.
+
+f <- function(x) sys.call()
+g <- function() f(1)
+for (i in 1:20)
+  stopifnot(identical(g(), quote(f(1))))
+
+h <- function(x) sys.function()
+g <- function() h(1)
+for (i in 1:20)
+  stopifnot(identical(g(), h))
+
+# Non-local return through a promise into the inlinee
+k <- function(a) a
+f <- function() {
+  k(return(1))
+  2
+}
+g <- function() f() + 1
+for (i in 1:20)
+  stopifnot(g() == 2)
+
+# The inlinee needs its environment, thus a full context
+f <- function(x) {
+  on.exit(x <- 2)
+  x
+}
+g <- function() f(1)
+for (i in 1:20)
+  stopifnot(g() == 1)
+
+# Errors unwind through the inlined contexts
+f <- function(x) if (x) stop("err") else x
+g <- function(x) f(x) + 1
+for (i in 1:20) {
+  stopifnot(g(FALSE) == 1)
+  stopifnot(inherits(tryCatch(g(TRUE), error = function(e) e), "error"))
+}
@@ -0,0 +1,69 @@
+# The inliner spends its fuel on the hottest call sites first, instead of
+# going in visitor order. Make sure the reordering does not change results.
+
+cold <- function(x) x - 1
+hot <- function(x) x + 1
+warm <- function(x) x * 2
+
+f <- function(n) {
+  s <- cold(0)
+  for (i in 1:n) {
+    s <- hot(s)
+    if (i %% 10 == 0)
+      s <- warm(s)
+  }
+  s + cold(1)
+}
+
+expected <- f(25)
+for (i in 1:50)
+  stopifnot(f(25) == expected)
+stopifnot(expected == 61)
+
+jitOn <- as.numeric(Sys.getenv("R_ENABLE_JIT", unset=2)) != 0
+jitOn <- jitOn && (Sys.getenv("PIR_ENABLE", unset="on") == "on")
+if (!jitOn || Sys.getenv("ROOT_DIR") == "" ||
+    Sys.getenv("PIR_OPT_LEVEL") != "" ||
+    Sys.getenv("PIR_DEOPT_CHAOS") != "")
+  quit()
+
+# The inliner parameters are read once at startup, thus the decisions are
+# checked on the PrintInliner log of a fresh R process
+inlinerLog <- function(...) {
+  script <- tempfile(fileext = ".R")
+  writeLines(c(
+    sprintf("dyn.load('%s')", getLoadedDLLs()[["librir"]][["path"]]),
+    sprintf("source('%s')", file.path(Sys.getenv("ROOT_DIR"), "rir/R/rir.R")),
+    sapply(c("cold", "hot", "warm", "f"), function(n)
+      paste(n, "<-", paste(deparse(get(n)), collapse = "\n"))),
+    "for (i in 1:3) f(25)",
+    "pir.compile(rir.compile(f), pir.debugFlags(PrintInliner = TRUE))",
+    sprintf("stopifnot(f(25) == %d)", expected)), script)
+  log <- system2(file.path(R.home("bin"), "R"),
+                 c("--no-init-file", "--slave", "-f", script),
+                 stdout = TRUE, env = c(...))
+  stopifnot(is.null(attr(log, "status")))
+  log[grepl("^Inliner: ", log)]
+}
+
+# The taken counts of the inlined call sites, in the order they were inlined.
+# The global functions are all called "unknown--fromConstant" in PIR.
+inlined <- function(log) {
+  log <- log[grepl("^Inliner: inlined ", log)]
+  as.numeric(sub(".*, taken ([0-9.e+]+)\\).*", "\\1", log))
+}
+
+# Every decision is reported, by default all four call sites get inlined
+log <- inlinerLog()
+stopifnot(length(inlined(log)) >= 4)
+
+# With fuel for a single call site the loop body (taken 25 times per call,
+# warm 2.5 and cold once) goes first
+log <- inlinerLog("PIR_INLINER_INITIAL_FUEL=1")
+stopifnot(inlined(log)[[1]] > 10)
+stopifnot(any(grepl("^Inliner: out of fuel", log)))
+
+# Nothing is copied once the module budget is spent
+log <- inlinerLog("PIR_INLINER_MODULE_BUDGET=0")
+stopifnot(length(inlined(log)) == 0)
+stopifnot(any(grepl("^Inliner: module budget exhausted", log)))
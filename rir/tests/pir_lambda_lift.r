@@ -0,0 +1,97 @@
+# Local closures which are only called get lifted out of their defining
+# environment, the locals they use are passed as arguments. Check that the
+# observable behavior stays the same in all the cases where this must not
+# happen.
+
+y <- 100
+
+# The inner functions are padded, such that the inliner leaves them alone
+pad <- function(res)
+  as.call(c(as.name("{"), quote(t <- 0),
+            lapply(1:40, function(j) bquote(t <- t + sin(a * .(j)))),
+            bquote(.(res) + 0 * t)))
+warmup <- function(f) for (i in 1:20) f(3)
+
+# Lifted: only uses its argument and globals
+f <- eval(bquote(function(n) {
+  sq <- function(a) .(pad(quote(a * a + y)))
+  s <- 0
+  for (i in 1:n)
+    s <- s + sq(i)
+  s
+}))
+stopifnot(pir.check(f, NoLocalClosureEnv, warmup = warmup))
+stopifnot(f(3) == 314)
+
+# Lifted: captures a local, must see the updated value
+f <- eval(bquote(function(n) {
+  k <- 1
+  add <- function(a) .(pad(quote(a + k)))
+  s <- 0
+  for (i in 1:n) {
+    s <- s + add(i)
+    k <- k + 1
+  }
+  s
+}))
+stopifnot(pir.check(f, NoLocalClosureEnv, warmup = warmup))
+stopifnot(f(3) == 12)
+
+# Writes to the defining environment
+f <- eval(bquote(function(n) {
+  k <- 1
+  add <- function(a) {
+    k <<- k + 1
+    .(pad(quote(a + k)))
+  }
+  add(n) + add(n) + k
+}))
+stopifnot(!pir.check(f, NoLocalClosureEnv, warmup = warmup))
+stopifnot(f(3) == 14)
+
+# Shadows a global with the same name
+f <- function() {
+  y <- 1
+  g <- function() y
+  g()
+}
+for (i in 1:20)
+  stopifnot(f() == 1)
+
+# Escapes, the environment is observable
+f <- function() {
+  x <- 2
+  g <- function() 1
+  g
+}
+for (i in 1:20)
+  stopifnot(get("x", environment(f())) == 2)
+
+# Reflective access from the inner function
+f <- function() {
+  x <- 3
+  g <- function() get("x", parent.env(environment()))
+  g()
+}
+for (i in 1:20)
+  stopifnot(f() == 3)
+
+# Binding created reflectively in the outer function
+f <- function() {
+  g <- function() z
+  assign("z", 4)
+  g()
+}
+for (i in 1:20)
+  stopifnot(f() == 4)
+
+# Superassignment from another local closure
+f <- function() {
+  h <- function() w <<- 5
+  g <- function() w
+  w <- 0
+  h()
+  g()
+}
+for (i in 1:20)
+  stopifnot(f() == 5)
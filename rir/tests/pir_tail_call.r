@@ -0,0 +1,47 @@
+# Self-recursive tail calls are turned into loops
+
+sumTo <- function(n, acc) {
+  if (n == 0)
+    acc
+  else
+    sumTo(n - 1, acc + n)
+}
+for (i in 1:20)
+  stopifnot(sumTo(1000, 0) == 500500)
+
+# Argument evaluation order and laziness must be preserved
+count <- 0
+f <- function(n, x) {
+  if (n == 0)
+    return(count)
+  f(n - 1, {count <<- count + 1})
+}
+for (i in 1:20) {
+  count <- 0
+  stopifnot(f(10, 0) == 0)
+}
+
+countDown <- function(n, acc) {
+  if (n == 0)
+    return(acc)
+  countDown(n - 1, c(acc, n))
+}
+for (i in 1:20)
+  stopifnot(identical(countDown(5, NULL), c(5, 4, 3, 2, 1)))
+
+# Non-tail recursion
+fib <- function(n) if (n < 2) n else fib(n - 1) + fib(n - 2)
+for (i in 1:20)
+  stopifnot(fib(15) == 610)
+
+# Frames must stay observable when the environment is needed
+depth <- function(n) {
+  if (n == 0)
+    return(sys.nframe())
+  depth(n - 1)
+}
+d0 <- depth(0)
+for (i in 1:20) {
+  d5 <- depth(5)
+  stopifnot(d5 == d0 + 5)
+}
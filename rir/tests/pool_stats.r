@@ -0,0 +1,31 @@
+# Constant pool slots owned by native code are freed once the code is
+# collected, and reused afterwards.
+
+s <- rir.poolStats()
+stopifnot(identical(names(s), c("size", "free", "interned", "owned")))
+stopifnot(s[["size"]] > 0, s[["free"]] <= s[["size"]])
+
+for (i in 1:5) {
+  g <- pir.compile(rir.compile(function(x) x + 1))
+  f <- rir.compile(function(x) g(x) * 2)
+  for (j in 1:3)
+    stopifnot(f(j) == 2 * (j + 1))
+  f <- pir.compile(f)
+  stopifnot(f(1) == 4)
+}
+before <- rir.poolStats()
+stopifnot(before[["owned"]] > s[["owned"]])
+rm(f, g)
+# The second collection frees what only the finalized code kept alive
+invisible(gc())
+invisible(gc())
+after <- rir.poolStats()
+stopifnot(after[["free"]] > before[["free"]])
+stopifnot(after[["owned"]] < before[["owned"]])
+
+# Freed slots are reused before the pool grows
+g <- pir.compile(rir.compile(function(x) x + 1))
+stopifnot(g(1) == 2)
+reused <- rir.poolStats()
+stopifnot(reused[["free"]] < after[["free"]] ||
+          reused[["size"]] == after[["size"]])
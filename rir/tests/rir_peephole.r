@@ -0,0 +1,116 @@
+# The baseline bytecode is cleaned up before it is finalized. Check that
+# constant branches, unreachable code and visibility survive it, and that the
+# cleanup actually happened.
+
+# Labels ("3:") and instructions ("br_  3") of the disassembly
+code <- function(f) {
+  d <- rir.disassemble(f, asText = TRUE)
+  d <- d[grepl("^[0-9]+:$", d) | grepl("^ *[0-9]* +[a-z]", d)]
+  sub("^ *[0-9]* +", "", d)
+}
+opcodes <- function(f) sub(" .*", "", code(f))
+branches <- c("br_", "brtrue_", "brfalse_", "asbool_brtrue_")
+noBranches <- function(f) !any(opcodes(f) %in% branches)
+noJumpChains <- function(f) {
+  c <- code(f)
+  for (jmp in c[sub(" .*", "", c) %in% branches]) {
+    target <- match(paste0(sub("^[a-z_]+ +", "", jmp), ":"), c)
+    if (sub(" .*", "", c[[target + 1]]) == "br_")
+      return(FALSE)
+  }
+  TRUE
+}
+
+f <- function() if (TRUE) 1 else 2
+stopifnot(f() == 1)
+stopifnot(noBranches(f), sum(opcodes(f) == "push_") == 1)
+f <- function() if (FALSE) 1 else 2
+stopifnot(f() == 2)
+stopifnot(noBranches(f), sum(opcodes(f) == "push_") == 1)
+f <- function() if (FALSE) 1
+stopifnot(is.null(f()))
+stopifnot(!withVisible(f())$visible)
+stopifnot(noBranches(f))
+
+f <- function() {
+  i <- 0
+  while (TRUE) {
+    i <- i + 1
+    if (i > 10)
+      break
+  }
+  i
+}
+stopifnot(f() == 11)
+stopifnot(noJumpChains(f))
+
+f <- function() {
+  i <- 0
+  while (FALSE)
+    i <- i + 1
+  i
+}
+stopifnot(f() == 0)
+stopifnot(!any(opcodes(f) %in% c("brtrue_", "brfalse_", "add_")))
+
+f <- function(n) {
+  s <- 0
+  repeat {
+    n <- n - 1
+    if (n %% 2 == 0)
+      next
+    if (n < 0)
+      break
+    s <- s + n
+  }
+  s
+}
+stopifnot(f(10) == 25)
+stopifnot(noJumpChains(f))
+
+f <- function(x) {
+  return(x)
+  stop("unreachable")
+}
+stopifnot(f(3) == 3)
+stopifnot(!any(grepl("stop", code(f))))
+
+f <- function(x) {
+  if (x)
+    return(1)
+  else
+    return(2)
+  3
+}
+stopifnot(f(TRUE) == 1 && f(FALSE) == 2)
+stopifnot(!any(code(f) == "push_  3"))
+
+# Jumps to jumps go to the final target
+f <- function(x, y) {
+  if (x) {
+    if (y)
+      a <- 1
+    else
+      a <- 2
+  } else {
+    a <- 3
+  }
+  a
+}
+stopifnot(f(TRUE, TRUE) == 1 && f(TRUE, FALSE) == 2 && f(FALSE, TRUE) == 3)
+stopifnot(noJumpChains(f))
+
+# Visibility of the last value is kept
+f <- function() x <- 1
+stopifnot(!withVisible(f())$visible)
+f <- function() { x <- 1; x }
+stopifnot(withVisible(f())$visible)
+f <- function() invisible(1)
+stopifnot(!withVisible(f())$visible)
+f <- function() { invisible(1); 2 }
+stopifnot(withVisible(f())$visible)
+
+# Promises containing constant branches
+g <- function(a) a
+f <- function() g(if (TRUE) "a" else "b")
+stopifnot(f() == "a")
@@ -0,0 +1,33 @@
+# The condition of an if is compiled to a fused asbool_brtrue_. Check that it
+# behaves like asbool_ followed by brtrue_, in the interpreter and in PIR.
+
+f <- function(x) if (x) "yes" else "no"
+g <- function(x) {
+  r <- 0
+  for (i in x)
+    if (i > 2) r <- r + i
+  r
+}
+
+for (i in 1:20) {
+  stopifnot(f(TRUE) == "yes")
+  stopifnot(f(FALSE) == "no")
+  stopifnot(f(1L) == "yes")
+  stopifnot(f(0) == "no")
+  stopifnot(f("true") == "yes")
+  stopifnot(g(1:5) == 12)
+}
+
+err <- function(x) tryCatch(f(x), error = function(e) conditionMessage(e))
+stopifnot(err(NA) == "missing value where TRUE/FALSE needed")
+stopifnot(err(logical(0)) == "argument is of length zero")
+stopifnot(err("foo") == "argument is not interpretable as logical")
+
+# Compiled with a feedback-driven assumption on the branch, the other branch
+# has to deopt into the fused instruction
+h <- rir.compile(function(x) if (x > 0) 1 else -1)
+for (i in 1:20)
+  stopifnot(h(i) == 1)
+pir.compile(h)
+stopifnot(h(-1) == -1)
+stopifnot(h(1) == 1)
@@ -0,0 +1,53 @@
+# The cases of switch() are dispatched through a jump table in native code.
+# Check defaults, fallthrough groups, duplicated names and NA.
+
+f <- function(x)
+  switch(x, "one", "two", "three", "four", "five")
+for (i in 1:3) {
+  stopifnot(identical(f(1L), "one"))
+  stopifnot(identical(f(3), "three"))
+  stopifnot(identical(f(5L), "five"))
+  stopifnot(is.null(f(0L)))
+  stopifnot(is.null(f(6L)))
+  stopifnot(is.null(f(-1L)))
+  stopifnot(is.null(f(NA_integer_)))
+  stopifnot(is.null(f(NA_real_)))
+}
+
+f <- function(x)
+  switch(x, a = 1, b = , c = 3, d = 4, "a" = 5, e = , f = 6, 0)
+for (i in 1:3) {
+  stopifnot(f("a") == 1)
+  stopifnot(f("b") == 3 && f("c") == 3)
+  stopifnot(f("d") == 4)
+  stopifnot(f("e") == 6 && f("f") == 6)
+  stopifnot(f("g") == 0)
+  stopifnot(f("") == 0)
+  stopifnot(f(NA_character_) == 0)
+}
+
+# No default, and a case called NA
+f <- function(x) switch(x, x = 1, y = 2, z = 3, "NA" = 4)
+for (i in 1:3) {
+  stopifnot(f("y") == 2)
+  stopifnot(is.null(f("w")))
+  stopifnot(f(NA_character_) == 4)
+  stopifnot(f("NA") == 4)
+}
+
+# Strings not shared with the names, encodings and attributes
+f <- function(x) switch(x, abc = 1, "caf\u00e9" = 2, def = 3, ghi = 4, 5)
+for (i in 1:3) {
+  stopifnot(f(paste0("a", "bc")) == 1)
+  stopifnot(f(substr("xghi", 2, 4)) == 4)
+  stopifnot(f("caf\u00e9") == 2)
+  stopifnot(f(iconv("caf\u00e9", "UTF-8", "latin1")) == 2)
+  stopifnot(f(c(k = "def")) == 3)
+  stopifnot(f(structure("abc", class = "foo")) == 1)
+  stopifnot(f(as.character(1:2)[[2]]) == 5)
+}
+
+# Errors of the comparisons are kept
+f <- function(x) switch(x, a = 1, b = 2, c = 3)
+stopifnot(inherits(tryCatch(f(c("a", "b")), error = identity), "error"))
+stopifnot(inherits(tryCatch(f(NULL), error = identity), "error"))
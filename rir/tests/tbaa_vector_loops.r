@@ -0,0 +1,51 @@
+# Loads of vector headers and payloads are annotated for alias analysis in
+# native code. Check loops which mix them with stores to the same vectors.
+
+f <- function(n) {
+  x <- numeric(n)
+  for (i in seq_along(x))
+    x[[i]] <- length(x) - i
+  x
+}
+stopifnot(identical(f(5), c(4, 3, 2, 1, 0)))
+
+f <- function(x) {
+  for (i in 2:length(x))
+    x[[i]] <- x[[i]] + x[[i - 1L]]
+  x
+}
+stopifnot(identical(f(1:6), c(1L, 3L, 6L, 10L, 15L, 21L)))
+stopifnot(identical(f(c(1, 2, 3)), c(1, 3, 6)))
+
+# Growing vectors are reallocated, their length has to be reloaded
+f <- function(n) {
+  x <- integer(0)
+  s <- 0L
+  for (i in 1:n) {
+    x[[i]] <- i
+    s <- s + length(x)
+  }
+  s
+}
+stopifnot(f(10L) == 55L)
+
+# Attributes and the sexptype change under a loop
+f <- function(x) {
+  r <- logical(length(x))
+  for (i in seq_along(x)) {
+    r[[i]] <- is.null(names(x))
+    names(x) <- letters[seq_along(x)]
+  }
+  r
+}
+stopifnot(identical(f(c(1, 2, 3)), c(TRUE, FALSE, FALSE)))
+
+f <- function(l) {
+  s <- 0
+  for (i in seq_along(l)) {
+    l[[i]] <- l[[i]] * 2
+    s <- s + l[[i]]
+  }
+  s
+}
+stopifnot(f(list(1, 2L, 3)) == 12)
@@ -0,0 +1,61 @@
+# Scalar arithmetic and for loop counters stay unboxed on the interpreter
+# stack. Check that they are boxed whenever they escape.
+
+f <- function(n) {
+  s <- 0L
+  for (i in 1:n)
+    s <- s + i * 2L - 1L
+  s
+}
+stopifnot(identical(f(100L), 10000L))
+
+f <- function(x) {
+  s <- 0
+  for (i in seq_along(x))
+    s <- s + x[[i]] * 0.5
+  s
+}
+stopifnot(f(c(1, 2, 3, 4)) == 5)
+
+# Escaping into calls and environments
+f <- function(a, b) {
+  l <- list()
+  for (i in 1:3)
+    l[[i]] <- c(a + b, i, a * b + i)
+  l
+}
+stopifnot(identical(f(2L, 3L), list(c(5L, 1L, 7L), c(5L, 2L, 8L),
+                                    c(5L, 3L, 9L))))
+f <- function(a) identity(a + 1) + length(a - 1)
+stopifnot(f(1) == 3)
+f <- function(a) {
+  g <- function() a + 1
+  g()
+}
+stopifnot(f(1L) == 2L)
+
+# Overflow, NA and mixed types take the slow path
+f <- function(a, b) a + b
+stopifnot(is.na(suppressWarnings(f(.Machine$integer.max, 1L))))
+w <- tryCatch(f(.Machine$integer.max, 1L), warning = function(w) "warned")
+stopifnot(w == "warned")
+stopifnot(is.na(f(NA_integer_, 1L)))
+stopifnot(is.na(f(NA_real_, 1)))
+stopifnot(identical(f(1L, 1.5), 2.5))
+f <- function(a, b) a < b
+stopifnot(is.na(f(NA_integer_, 1L)))
+stopifnot(is.na(f(NaN, 1)))
+stopifnot(f(1L, 2L) && !f(2, 1))
+
+# Visibility
+f <- function(a) a + 1L
+stopifnot(withVisible(f(1L))$visible)
+
+# Long running loops go through OSR with the counter on the stack
+f <- function(n) {
+  s <- 0
+  for (i in 1:n)
+    s <- s + i
+  s
+}
+stopifnot(f(20000) == 200010000)